@@ -2,14 +2,25 @@
 
 #include <aig/aig.h>
 #include <inttypes.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 int main(int argc, char **argv) {
 
+  const char *argv0 = argv[0];
+
+  // should we write DIMACS CNF instead of SMT-LIB?
+  bool cnf = false;
+  if (argc > 1 && strcmp(argv[1], "--cnf") == 0) {
+    cnf = true;
+    --argc;
+    ++argv;
+  }
+
   if (argc < 2 || argc > 3) {
-    fprintf(stderr, "usage: %s filename [output filename]\n", argv[0]);
+    fprintf(stderr, "usage: %s [--cnf] filename [output filename]\n", argv0);
     return EXIT_FAILURE;
   }
 
@@ -29,9 +40,16 @@ int main(int argc, char **argv) {
     }
   }
 
-  if ((rc = aig_to_sat_file(aig, out))) {
-    fprintf(stderr, "aig_to_sat_file: %s\n", strerror(rc));
-    return EXIT_FAILURE;
+  if (cnf) {
+    if ((rc = aig_to_cnf_file(aig, out))) {
+      fprintf(stderr, "aig_to_cnf_file: %s\n", strerror(rc));
+      return EXIT_FAILURE;
+    }
+  } else {
+    if ((rc = aig_to_sat_file(aig, out))) {
+      fprintf(stderr, "aig_to_sat_file: %s\n", strerror(rc));
+      return EXIT_FAILURE;
+    }
   }
 
   fclose(out);
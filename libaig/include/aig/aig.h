@@ -20,6 +20,19 @@ struct aig_options {
 
   /// parse entire AIG file on load
   bool eager;
+
+  /// with aig_load(), read the file by mapping it into memory instead of
+  /// through stdio
+  bool memory_map;
+
+  /// store AND gate operands relative to their gate, in a compressed form
+  /// that uses less memory for typical AIGs at the cost of slightly slower
+  /// access
+  bool compress;
+
+  /// maximum number of threads to use for work that can be parallelised (0
+  /// or 1 for single threaded)
+  size_t threads;
 };
 
 // AIG create/delete functions /////////////////////////////////////////////////
@@ -59,6 +72,23 @@ int aig_loadf(aig_t **aig, FILE *f, struct aig_options options);
  */
 int aig_parse(aig_t **aig, const char *content, struct aig_options options);
 
+/** allocate a new AIG and initialise it from the given in-memory data
+ *
+ * The data is parsed in place, without copying it. It does not need to be NUL
+ * terminated. If options.eager is set, the buffer is no longer referenced once
+ * this function returns. Otherwise, the AIG retains a reference to the buffer
+ * for parsing on demand, so the buffer must remain valid and unmodified until
+ * the AIG is freed.
+ *
+ * \param aig [out] Handle to the initialised data structure
+ * \param buffer AIG data to read and parse
+ * \param length Number of bytes in buffer
+ * \param options Configuration for parsing
+ * \returns 0 on success or an errno on failure
+ */
+int aig_parse_buffer(aig_t **aig, const void *buffer, size_t length,
+  struct aig_options options);
+
 /** deallocate resources associated with an AIG
  *
  * \param aig [in,out] Handle to data structure to deallocate and set to NULL
@@ -285,6 +315,89 @@ int aig_get_latch_no_symbol(aig_t *aig, uint64_t index,
 int aig_get_output_no_symbol(aig_t *aig, uint64_t index,
   struct aig_node *result);
 
+/** lookup a node by variable index without its symbol
+ *
+ * This is similar to aig_get_node() but will not attempt to further parse the
+ * symbol table from the backing AIG. Only as much of the AIG as is needed to
+ * find the node is parsed. This is effectively an optimised, cheaper version
+ * of aig_get_node() when you do not need symbol information.
+ *
+ * \param aig AIG data structure to search
+ * \param variable_index Index of the sought node
+ * \param result [out] The located node if successful
+ * \returns 0 on success or an errno on failure
+ */
+int aig_get_node_no_symbol(aig_t *aig, uint64_t variable_index,
+  struct aig_node *result);
+
+/** retrieve a contiguous range of inputs in this AIG
+ *
+ * This is equivalent to, but much cheaper than, calling
+ * aig_get_input_no_symbol() on each input in the range. Inputs are returned in
+ * their AIGER encoding, i.e. twice their variable index.
+ *
+ * \param aig AIG data structure to read from
+ * \param first Index of the first input to retrieve
+ * \param count Number of inputs to retrieve
+ * \param inputs [out] Array of at least count elements to write into
+ * \returns 0 on success or an errno on failure
+ */
+int aig_get_inputs(aig_t *aig, uint64_t first, uint64_t count,
+  uint64_t *inputs);
+
+/** retrieve a contiguous range of latches in this AIG
+ *
+ * This is equivalent to, but much cheaper than, calling
+ * aig_get_latch_no_symbol() on each latch in the range. Values are returned in
+ * their AIGER encoding, i.e. twice the variable index plus one if negated.
+ *
+ * \param aig AIG data structure to read from
+ * \param first Index of the first latch to retrieve
+ * \param count Number of latches to retrieve
+ * \param current [out] Optional array of at least count elements to write the
+ *   current states into
+ * \param next [out] Optional array of at least count elements to write the next
+ *   states into
+ * \returns 0 on success or an errno on failure
+ */
+int aig_get_latches(aig_t *aig, uint64_t first, uint64_t count,
+  uint64_t *current, uint64_t *next);
+
+/** retrieve a contiguous range of outputs in this AIG
+ *
+ * This is equivalent to, but much cheaper than, calling
+ * aig_get_output_no_symbol() on each output in the range. Outputs are returned
+ * in their AIGER encoding, i.e. twice the variable index plus one if negated.
+ *
+ * \param aig AIG data structure to read from
+ * \param first Index of the first output to retrieve
+ * \param count Number of outputs to retrieve
+ * \param outputs [out] Array of at least count elements to write into
+ * \returns 0 on success or an errno on failure
+ */
+int aig_get_outputs(aig_t *aig, uint64_t first, uint64_t count,
+  uint64_t *outputs);
+
+/** retrieve a contiguous range of AND gates in this AIG
+ *
+ * This is equivalent to, but much cheaper than, calling aig_get_and() on each
+ * AND gate in the range. Values are returned in their AIGER encoding, i.e.
+ * twice the variable index plus one if negated.
+ *
+ * \param aig AIG data structure to read from
+ * \param first Index of the first AND gate to retrieve
+ * \param count Number of AND gates to retrieve
+ * \param lhs [out] Optional array of at least count elements to write the LHSs
+ *   into
+ * \param rhs0 [out] Optional array of at least count elements to write the
+ *   first operands into
+ * \param rhs1 [out] Optional array of at least count elements to write the
+ *   second operands into
+ * \returns 0 on success or an errno on failure
+ */
+int aig_get_ands(aig_t *aig, uint64_t first, uint64_t count, uint64_t *lhs,
+  uint64_t *rhs0, uint64_t *rhs1);
+
 /** lookup a node by name
  *
  * \param aig AIG data structure to search
@@ -305,6 +418,47 @@ typedef struct aig_node_iter aig_node_iter_t;
  */
 int aig_iter(aig_t *aig, aig_node_iter_t **it);
 
+/** create a new iterator over this AIG’s nodes that omits their symbols
+ *
+ * This is similar to aig_iter() but the nodes it yields are retrieved as if by
+ * aig_get_input_no_symbol() and friends. The AIG is only parsed as far as the
+ * nodes the iterator has yielded.
+ *
+ * \param aig The AIG to iterate over
+ * \param it [out] A created iterator on success
+ * \returns 0 on success or an errno on failure
+ */
+int aig_iter_no_symbol(aig_t *aig, aig_node_iter_t **it);
+
+/** create a new iterator over this AIG’s AND gates in level order
+ *
+ * All AND gates at one level are yielded before any at the next level up.
+ * Within a level, they are yielded in increasing index order. See
+ * aig_node_level() for the meaning of level. As with aig_iter_topological(),
+ * latches are treated as inputs, so feedback through a latch is permitted.
+ *
+ * \param aig The AIG to iterate over
+ * \param it [out] A created iterator on success
+ * \returns 0 on success, ELOOP if the AND gates contain a cycle, or another
+ *   errno on failure
+ */
+int aig_iter_level(aig_t *aig, aig_node_iter_t **it);
+
+/** create a new iterator over this AIG’s AND gates in topological order
+ *
+ * Every AND gate is yielded after any AND gates defining its inputs. Latches
+ * are treated as inputs, so feedback through a latch is permitted. When the
+ * AND gates are already in this order, as in any well formed binary AIG, they
+ * are yielded in index order and no additional memory is used. Otherwise, an
+ * order is computed once and kept for the lifetime of the AIG.
+ *
+ * \param aig The AIG to iterate over
+ * \param it [out] A created iterator on success
+ * \returns 0 on success, ELOOP if the AND gates contain a cycle, or another
+ *   errno on failure
+ */
+int aig_iter_topological(aig_t *aig, aig_node_iter_t **it);
+
 /** is this AIG iterator not exhausted?
  *
  * \param it Iterator to examine
@@ -336,6 +490,19 @@ void aig_iter_free(aig_node_iter_t **it);
 int aig_iter_fanout(aig_t *aig, const struct aig_node *node,
   aig_node_iter_t **it);
 
+/** find how the node last yielded by a fanout iterator uses the iterator’s node
+ *
+ * An AND gate can take the same variable as either or both of its operands,
+ * and this identifies which.
+ *
+ * \param it Iterator created by aig_iter_fanout() that has yielded a node
+ * \param pins [out] On success, a bitmask with bit 0 set if the node’s first
+ *   operand (or for a latch, its next state) is the iterator’s node and bit 1
+ *   set if the node’s second operand is
+ * \returns 0 on success or an errno on failure
+ */
+int aig_iter_fanout_pins(const aig_node_iter_t *it, unsigned *pins);
+
 /** get the number of nodes taking the given node as an input in this AIG
  *
  * \param aig The containing AIG
@@ -345,17 +512,194 @@ int aig_iter_fanout(aig_t *aig, const struct aig_node *node,
  */
 int aig_fanout_count(aig_t *aig, const struct aig_node *node, size_t *count);
 
-/** get the level (maximum distance to an input) of a node within an AIG
+/** count the references to every variable in this AIG
+ *
+ * This is a single pass over the whole AIG, and is much cheaper than calling
+ * aig_fanout_count() on each node. Unlike aig_fanout_count(), an AND gate
+ * that uses a variable as both its operands counts as two references to it.
+ * If the AIG was created with more than one thread, the AND gates are counted
+ * in parallel.
+ *
+ * \param aig The AIG to examine
+ * \param latches Whether to count references from latch next states
+ * \param outputs Whether to count references from outputs
+ * \param counts [out] Array of at least aig_max_index() + 1 elements to write
+ *   the number of references to each variable into
+ * \returns 0 on success or an errno on failure
+ */
+int aig_fanout_counts(aig_t *aig, bool latches, bool outputs, size_t *counts);
+
+/** get the level (maximum distance to an input or latch) of a node within an
+ * AIG
  *
- * This function assumes the containing AIG is valid and contains no cycles.
+ * Latches are treated like inputs, with level 0, so feedback through a latch
+ * is permitted.
  *
  * \param aig The containing AIG
  * \param node The node to examine
  * \param level [out] The level of this node on success
- * \returns 0 on success or an errno on failure
+ * \returns 0 on success, ELOOP if the AND gates contain a cycle, or another
+ *   errno on failure
  */
 int aig_node_level(aig_t *aig, const struct aig_node *node, size_t *level);
 
+/** get the depth (maximum distance to an output or latch next state) of a node
+ * within an AIG
+ *
+ * This is the reverse of aig_node_level(), following the same edges: from
+ * each AND gate operand to the gate using it. Paths end at outputs and latch
+ * next states, and do not continue through latches. So the sum of a node’s
+ * level and depth is the length of the longest path through it.
+ *
+ * \param aig The containing AIG
+ * \param node The node to examine
+ * \param depth [out] The depth of this node on success
+ * \returns 0 on success, ENOENT if no output or latch next state is reachable
+ *   from this node, ELOOP if the AND gates contain a cycle, or another errno
+ *   on failure
+ */
+int aig_node_depth(aig_t *aig, const struct aig_node *node, size_t *depth);
+
+/** get the slack of a node within an AIG
+ *
+ * This is how much shorter the longest path through this node is than the
+ * longest path in the AIG ending at an output or latch next state. Nodes with
+ * a slack of 0 lie on a critical path.
+ *
+ * \param aig The containing AIG
+ * \param node The node to examine
+ * \param slack [out] The slack of this node on success
+ * \returns 0 on success, ENOENT if no output or latch next state is reachable
+ *   from this node, or another errno on failure
+ */
+int aig_node_slack(aig_t *aig, const struct aig_node *node, size_t *slack);
+
+/** get the level of every variable in an AIG
+ *
+ * \param aig The AIG to examine
+ * \param levels [out] Array of aig_max_index() + 1 elements, giving the level
+ *   of each variable, on success. This remains valid until the AIG is freed.
+ * \returns 0 on success or an errno on failure
+ */
+int aig_levels(aig_t *aig, const uint32_t **levels);
+
+/** get the depth of every variable in an AIG
+ *
+ * \param aig The AIG to examine
+ * \param depths [out] Array of aig_max_index() + 1 elements, giving the depth
+ *   of each variable, or UINT32_MAX for a variable from which no output or
+ *   latch next state is reachable, on success. This remains valid until the
+ *   AIG is freed.
+ * \returns 0 on success or an errno on failure
+ */
+int aig_depths(aig_t *aig, const uint32_t **depths);
+
+/** find the variables on critical paths in an AIG
+ *
+ * \param aig The AIG to examine
+ * \param variables [out] Variable indices with a slack of 0, in increasing
+ *   order, on success. The caller is responsible for freeing this.
+ * \param count [out] Number of entries in variables on success
+ * \returns 0 on success or an errno on failure
+ */
+int aig_critical_variables(aig_t *aig, uint64_t **variables, size_t *count);
+
+/** get the number of levels in an AIG
+ *
+ * This is one more than the greatest level of any AND gate, so levels range
+ * from 0 up to this value exclusive. Level 0 never contains AND gates.
+ *
+ * \param aig The AIG to examine
+ * \param count [out] The number of levels on success
+ * \returns 0 on success or an errno on failure
+ */
+int aig_level_count(aig_t *aig, size_t *count);
+
+/** get the AND gates at a given level of an AIG
+ *
+ * The gates are returned as a contiguous slice of indices, suitable for use
+ * with aig_get_and(), in increasing order. The gates within a level do not
+ * depend on one another, so a caller may process a slice in parallel.
+ *
+ * Each gate lies one level above the deepest of its operands. This is the
+ * level of its variable, unless an earlier node also defines that variable.
+ *
+ * \param aig The AIG to examine
+ * \param level Level to retrieve, less than the count from aig_level_count()
+ * \param gates [out] Indices of the AND gates at this level on success,
+ *   which remain valid until the AIG is freed
+ * \param count [out] Number of AND gates at this level on success
+ * \returns 0 on success or an errno on failure
+ */
+int aig_level_gates(aig_t *aig, size_t level, const uint64_t **gates,
+  size_t *count);
+
+////////////////////////////////////////////////////////////////////////////////
+
+// cone of influence ///////////////////////////////////////////////////////////
+
+/** find the cone of influence of some literals
+ *
+ * This is every variable that can affect the given literals, following AND
+ * gate operands and, if sequential is set, latch next states. Variables that
+ * nothing defines are treated as inputs.
+ *
+ * \param aig AIG to examine
+ * \param literals Literals whose cone to find, for example output values
+ * \param count Number of entries in literals
+ * \param sequential Whether to continue through latches
+ * \param cone [out] Bitset with aig_max_index() + 1 bits on success, where
+ *   bit v % 64 of cone[v / 64] is set if variable v is in the cone. The caller
+ *   is responsible for freeing this.
+ * \returns 0 on success or an errno on failure
+ */
+int aig_cone(aig_t *aig, const uint64_t *literals, size_t count,
+  bool sequential, uint64_t **cone);
+
+/** extract the cone of influence of some literals as a standalone AIG
+ *
+ * The resulting AIG has the given literals as its outputs, in order, and
+ * contains only the nodes in their cone as found by aig_cone(). Its variables
+ * are renumbered compactly: inputs and latches in order of their original
+ * variable index, then AND gates in topological order. In a combinational
+ * cone, latches become inputs. Symbols are not retained.
+ *
+ * \param aig AIG to examine
+ * \param literals Literals whose cone to extract
+ * \param count Number of entries in literals
+ * \param sequential Whether to continue through latches
+ * \param cone [out] The extracted AIG on success
+ * \returns 0 on success, ELOOP if the AND gates in the cone contain a cycle,
+ *   or another errno on failure
+ */
+int aig_cone_extract(aig_t *aig, const uint64_t *literals, size_t count,
+  bool sequential, aig_t **cone);
+
+/** find the transitive fanout of some variables
+ *
+ * This is every variable that the given variables can affect, following the
+ * fanout edges seen by aig_iter_fanout() and, if sequential is set, from latch
+ * next states to the latches themselves. The given variables are included.
+ * An AND gate that redefines a variable already defined by an earlier node is
+ * never used, so it is not followed.
+ *
+ * \param aig AIG to examine
+ * \param variables Variable indices to start from
+ * \param count Number of entries in variables
+ * \param sequential Whether to continue through latches
+ * \param cone [out] Bitset with aig_max_index() + 1 bits on success, where
+ *   bit v % 64 of cone[v / 64] is set if variable v is in the fanout. The
+ *   caller is responsible for freeing this.
+ * \param outputs [out] Optional indices, in increasing order, of the outputs
+ *   whose values are in the fanout on success. The caller is responsible for
+ *   freeing this.
+ * \param output_count [out] Number of entries in outputs on success. Required
+ *   if outputs is given.
+ * \returns 0 on success or an errno on failure
+ */
+int aig_fanout_cone(aig_t *aig, const uint64_t *variables, size_t count,
+  bool sequential, uint64_t **cone, uint64_t **outputs, size_t *output_count);
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // SAT generation //////////////////////////////////////////////////////////////
@@ -376,6 +720,44 @@ int aig_to_sat_string(aig_t *aig, char **sat);
  */
 int aig_to_sat_file(aig_t *aig, FILE *f);
 
+/** write a SAT representation of the cone of influence of some outputs
+ *
+ * This is similar to aig_to_sat_file() but only declares and constrains the
+ * inputs, latches, and AND gates that can affect the given outputs, as found
+ * by aig_cone() following latches. These are written in increasing order of
+ * variable index, each from the node that first defines its variable.
+ *
+ * \param aig AIG to translate
+ * \param outputs Indices of the outputs of interest
+ * \param count Number of entries in outputs
+ * \param f Output file to write to
+ * \returns 0 on success or an errno on failure
+ */
+int aig_to_sat_file_cone(aig_t *aig, const uint64_t *outputs, size_t count,
+  FILE *f);
+
+/** write a DIMACS CNF representation of an AIG to a file
+ *
+ * Each AND gate is Tseitin encoded as three clauses, and each latch is
+ * constrained to equal its next state with two clauses, matching
+ * aig_to_sat_file(). DIMACS variable v corresponds to AIG variable v, and the
+ * AIG’s constant is represented by an extra variable aig_max_index() + 1 that
+ * is constrained to be false.
+ *
+ * \param aig AIG to translate
+ * \param f Output file to write to
+ * \returns 0 on success or an errno on failure
+ */
+int aig_to_cnf_file(aig_t *aig, FILE *f);
+
+/** generate a DIMACS CNF representation of an AIG
+ *
+ * \param aig AIG to translate
+ * \param cnf [out] CNF problem corresponding to the AIG on success
+ * \returns 0 on success or an errno on failure
+ */
+int aig_to_cnf_string(aig_t *aig, char **cnf);
+
 /** generate a SAT representation of an AIG term
  *
  * \param node Node to translate
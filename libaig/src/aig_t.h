@@ -3,6 +3,9 @@
 #include <aig/aig.h>
 #include <assert.h>
 #include "bitbuffer.h"
+#include "deltabuffer.h"
+#include "exceptions.h"
+#include "source.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -25,13 +28,13 @@ struct aig {
   uint64_t and_count;
 
   /// input file (or in-memory buffer) AIG was read from
-  FILE *source;
+  source_t source;
 
-  /// inputs if not inferable
-  bitbuffer_t inputs;
+  /// inputs that differ from their inferred value
+  exceptions_t inputs;
 
-  /// current state values for each latch
-  bitbuffer_t latch_current;
+  /// latch current state values that differ from their inferred value
+  exceptions_t latch_current;
 
   /// next state values for each latch
   bitbuffer_t latch_next;
@@ -39,17 +42,53 @@ struct aig {
   /// output nodes
   bitbuffer_t outputs;
 
-  /// LHS of AND gates
-  bitbuffer_t and_lhs;
+  /// LHS of AND gates that differ from their inferred value
+  exceptions_t and_lhs;
 
   /// RHSs of AND gates
   bitbuffer_t and_rhs;
 
+  /// RHSs of AND gates, relative to their LHS, when using compressed storage
+  deltabuffer_t and_rhs_deltas;
+
+  /// variables defined by a node away from their inferred position, mapped to
+  /// the position of that node
+  exceptions_t node_map;
+
   /// optional symbol table
   char **symtab;
 
-  /// cache of node level information
-  size_t *levels;
+  /// level of every variable, once computed by levelize()
+  uint32_t *levels;
+
+  /// AND gates bucketed by level, once computed by bucket_levels(): the gates
+  /// at level l are level_gates[level_offsets[l]] up to
+  /// level_gates[level_offsets[l + 1]]
+  uint64_t *level_offsets;
+  uint64_t *level_gates;
+
+  /// number of levels in level_offsets
+  size_t level_count;
+
+  /// depth (maximum distance to an output or latch next state) of every
+  /// variable, once computed, with UINT32_MAX for those that reach neither
+  uint32_t *depths;
+
+  /// greatest level of any output or latch next state, once depths are
+  /// computed
+  uint32_t sink_level;
+
+  /// AND gate indices in topological order, once computed by topo_sort(), or
+  /// NULL if the gates are already in topological order
+  uint64_t *topo_order;
+
+  /// fanout index, in compressed sparse row form: the fanout edges of variable
+  /// v are entries fanout_offsets[v] up to fanout_offsets[v + 1] of
+  /// fanout_edges, read via the accessors in fanout.h
+  bitbuffer_t fanout_offsets;
+
+  /// fanout edges, encoded as described in fanout.h
+  bitbuffer_t fanout_edges;
 
   /// internal parsing state
   struct {
@@ -64,6 +103,9 @@ struct aig {
     uint64_t index;
   };
 
+  /// maximum number of threads to use for parallelisable work
+  size_t threads;
+
   /// was the source binary encoded instead of ASCII?
   uint8_t binary:1;
 
@@ -72,6 +114,15 @@ struct aig {
 
   /// are we using eager loading mode?
   uint8_t eager:1;
+
+  /// are AND gate RHSs stored in and_rhs_deltas instead of and_rhs?
+  uint8_t compress:1;
+
+  /// has node_map been constructed?
+  uint8_t node_map_built:1;
+
+  /// has topo_sort() been run?
+  uint8_t topo_sorted:1;
 };
 
 /** get the limit value to use for bit buffers in an AIG struct
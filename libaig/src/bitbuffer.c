@@ -3,18 +3,109 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// if we need to store values up to the given value, how many bits wide does
-// each entry need to be?
-static size_t entry_width(uint64_t limit) {
+/// number of bits in a word of the backing array
+enum { WORD_BITS = sizeof(uint64_t) * 8 };
 
-  if (limit == 0)
-    return 1;
+// grow the backing array to the given number of words
+static int grow(bitbuffer_t *bb, size_t words) {
 
-  return sizeof(unsigned long long) * 8 - __builtin_clzll(limit);
+  assert(bb != NULL);
+  assert(words > bb->capacity);
+
+  if (SIZE_MAX / sizeof(bb->words[0]) < words)
+    return ENOMEM;
+
+  uint64_t *w = realloc(bb->words, words * sizeof(w[0]));
+  if (w == NULL)
+    return ENOMEM;
+
+  // the new space is deliberately left uninitialised, as appends overwrite
+  // rather than combine with anything beyond the current size, so memory we
+  // reserve but never append into is never touched
+
+  bb->words = w;
+  bb->capacity = words;
+
+  return 0;
+}
+
+// ensure we have space for the given number of bits
+static int reserve_bits(bitbuffer_t *bb, size_t bits) {
+
+  assert(bb != NULL);
+
+  // round up to whole words, plus a trailing word so readers can always load
+  // the word following an entry
+  size_t words = bits / WORD_BITS + (bits % WORD_BITS != 0) + 1;
+
+  if (words <= bb->capacity)
+    return 0;
+
+  // grow geometrically, to amortise the cost of appends
+  size_t c = bb->capacity == 0 ? 1 : bb->capacity;
+  while (c < words) {
+    if (SIZE_MAX / 2 < c)
+      return ENOMEM;
+    c *= 2;
+  }
+
+  return grow(bb, c);
+}
+
+int bb_get_range(const bitbuffer_t *bb, uint64_t first, uint64_t count,
+    uint64_t limit, uint64_t *values) {
+
+  assert(bb != NULL);
+  assert(count == 0 || values != NULL);
+
+  size_t w = bb_entry_width(limit);
+
+  // do these entries lie beyond the extent of the buffer?
+  size_t entries = bb->size / w;
+  if (first > entries || count > entries - first)
+    return ERANGE;
+
+  const uint64_t *words = bb->words;
+  const uint64_t mask = w == WORD_BITS ? UINT64_MAX : (UINT64_C(1) << w) - 1;
+
+  // unpack each entry from the word it starts in and the word after it, which
+  // always exists due to the trailing word kept by reserve_bits(); this loop is
+  // branch free, which lets the compiler pipeline or vectorise it
+  size_t bit = first * w;
+  for (uint64_t i = 0; i < count; i++, bit += w) {
+    size_t index = bit / WORD_BITS;
+    size_t offset = bit % WORD_BITS;
+    uint64_t v = (words[index] >> offset)
+               | ((words[index + 1] << 1) << (WORD_BITS - 1 - offset));
+    values[i] = v & mask;
+  }
+
+  return 0;
+}
+
+int bb_reserve(bitbuffer_t *bb, uint64_t count, uint64_t limit) {
+
+  assert(bb != NULL);
+
+  size_t w = bb_entry_width(limit);
+
+  // how many bits will we need in total?
+  if ((SIZE_MAX - bb->size) / w < count)
+    return ENOMEM;
+  size_t bits = bb->size + count * w;
+
+  // round up to whole words, plus a trailing word as in reserve_bits()
+  size_t words = bits / WORD_BITS + (bits % WORD_BITS != 0) + 1;
+
+  if (words <= bb->capacity)
+    return 0;
+
+  // allocate exactly what was asked for, so appends up to this point neither
+  // reallocate nor over-allocate
+  return grow(bb, words);
 }
 
 int bb_append(bitbuffer_t *bb, uint64_t value, uint64_t limit) {
@@ -22,107 +113,164 @@ int bb_append(bitbuffer_t *bb, uint64_t value, uint64_t limit) {
   assert(value <= limit
     && "attempt to store an out-of-range value in a bit buffer");
 
-  // if the buffer has not been initialised, we need to create it now
-  if (bb->handle == NULL) {
-    bb->handle = open_memstream(&bb->buffer, &bb->buffer_size);
-    if (bb->handle == NULL)
-      return errno;
-  }
-
-  size_t w = entry_width(limit);
+  size_t w = bb_entry_width(limit);
 
   // the entry width we have calculated better not be more narrow than the value
   // we are trying to store
-  assert(value < UINT64_C(1) << w);
+  assert(w == WORD_BITS || value < UINT64_C(1) << w);
 
-  // write the entry bit-by-bit
-  // TODO: accelerate this by writing byte-by-byte
-  for (size_t i = 0; i < w; i++) {
-    uint64_t bit = (value >> i) & 1;
+  if (SIZE_MAX - bb->size < w)
+    return ENOMEM;
 
-    assert(bb->residue_bits < 8 && "incurred 1+ bytes in bit buffer's residue");
+  int rc = reserve_bits(bb, bb->size + w);
+  if (rc)
+    return rc;
 
-    // add this bit
-    bb->residue |= bit << bb->residue_bits;
-    bb->residue_bits++;
+  // write the entry into the word it starts in, preserving the prior entries
+  // below it, and then overwrite the following word with any part of it that
+  // spills (shifting in two steps so that an entry that does not spill writes
+  // 0 without an undefined 64-bit shift); this keeps every word up to and
+  // including the trailing one initialised
+  size_t index = bb->size / WORD_BITS;
+  size_t offset = bb->size % WORD_BITS;
+  uint64_t below = (UINT64_C(1) << offset) - 1;
+  bb->words[index] = (bb->words[index] & below) | (value << offset);
+  bb->words[index + 1] = (value >> 1) >> (WORD_BITS - 1 - offset);
 
-    // if we have a full byte, flush this to the buffer
-    if (bb->residue_bits == 8) {
-      size_t s = fwrite(&bb->residue, 1, 1, bb->handle);
-      if (s != 1)
-        return ENOMEM;
+  bb->size += w;
 
-      bb->residue = 0;
-      bb->residue_bits = 0;
-    }
-  }
+  return 0;
+}
+
+int bb_append_zeroes(bitbuffer_t *bb, uint64_t count, uint64_t limit) {
+
+  assert(bb != NULL);
+
+  size_t w = bb_entry_width(limit);
+  if ((SIZE_MAX - bb->size) / w < count)
+    return ENOMEM;
+
+  int rc = bb_reserve(bb, count, limit);
+  if (rc)
+    return rc;
+
+  // the words up to and including the trailing one are already zero beyond the
+  // current size, unless nothing has been appended yet, so clear everything
+  // after that up to and including the new trailing word
+  size_t bits = bb->size + count * w;
+  size_t from = bb->size == 0
+              ? 0 : bb->size / WORD_BITS + (bb->size % WORD_BITS != 0) + 1;
+  size_t to = bits / WORD_BITS + (bits % WORD_BITS != 0) + 1;
+  if (from < to)
+    memset(&bb->words[from], 0, (to - from) * sizeof(bb->words[0]));
+
+  bb->size = bits;
 
   return 0;
 }
 
-int bb_get(const bitbuffer_t *bb, uint64_t index, uint64_t limit,
-    uint64_t *value) {
+int bb_run_reserve(bitbuffer_t *bb, uint64_t count, uint64_t limit) {
 
   assert(bb != NULL);
-  assert(value != NULL);
 
-  // is this bit buffer empty?
-  if (bb == NULL)
-    return ERANGE;
-  if (bb->handle == NULL)
-    return ERANGE;
+  int rc = bb_reserve(bb, count, limit);
+  if (rc)
+    return rc;
 
-  // synchronise the buffer so we can access bb->buffer
-  fflush(bb->handle);
+  // no run writes beyond the last item, so clear the word that will then be the
+  // trailing one ahead of time
+  size_t bits = bb->size + count * bb_entry_width(limit);
+  bb->words[bits / WORD_BITS + (bits % WORD_BITS != 0)] = 0;
 
-  size_t w = entry_width(limit);
+  return 0;
+}
 
-  // does this entry lie beyond the extent of the buffer?
-  if (index * w + w > bb->buffer_size * 8 + bb->residue_bits)
-    return ERANGE;
+void bb_run_append(bitbuffer_t *bb, bb_run_t *run, uint64_t value,
+    uint64_t limit) {
+
+  assert(bb != NULL);
+  assert(run != NULL);
+  assert(value <= limit
+    && "attempt to store an out-of-range value in a bit buffer");
+
+  size_t w = bb_entry_width(limit);
+  assert(run->size + w <= (bb->capacity - 1) * WORD_BITS
+    && "run exceeds reservation");
 
-  // read out the entry
-  // TODO: accelerate this by doing it byte-by-byte
-  uint64_t v = 0;
-  for (size_t i = 0; i < w; i++) {
-    size_t byte_offset = (index * w + i) / 8;
-    size_t bit_offset = (index * w + i) % 8;
-
-    // extract the current bit
-    uint8_t byte = 0;
-    if (byte_offset < bb->buffer_size) {
-      byte = (uint8_t)bb->buffer[byte_offset];
+  // accumulate the entry into the word we are up to, as in bb_append()
+  size_t offset = run->size % WORD_BITS;
+  run->last |= value << offset;
+
+  // if this fills the word, move on to the next one, holding back the first
+  // word as it may be shared with the preceding run
+  if (offset + w >= WORD_BITS) {
+    size_t index = run->size / WORD_BITS;
+    if (index == run->start / WORD_BITS) {
+      run->first = run->last;
     } else {
-      assert(byte_offset == bb->buffer_size &&
-        "offset in bb_get() beyond the buffer and the residue byte");
-      byte = bb->residue;
+      bb->words[index] = run->last;
     }
-    uint64_t bit = (byte >> bit_offset) & 1;
+    run->last = (value >> 1) >> (WORD_BITS - 1 - offset);
+  }
 
-    // add it to the accumulated value
-    v |= bit << i;
+  run->size += w;
+}
+
+void bb_run_commit(bitbuffer_t *bb, const bb_run_t *run) {
+
+  assert(bb != NULL);
+  assert(run != NULL);
+  assert(run->start == bb->size && "run committed out of order");
+
+  if (run->size == run->start)
+    return;
+
+  // merge the run’s first word with the entries preceding it, then write its
+  // last word, which the following run (if any) will in turn merge with
+  size_t first = run->start / WORD_BITS;
+  size_t last = run->size / WORD_BITS;
+  uint64_t below = (UINT64_C(1) << (run->start % WORD_BITS)) - 1;
+  if (first == last) {
+    bb->words[first] = (bb->words[first] & below) | run->last;
+  } else {
+    bb->words[first] = (bb->words[first] & below) | run->first;
+    bb->words[last] = run->last;
   }
 
-  *value = v;
-  return 0;
+  bb->size = run->size;
+}
+
+void bb_run_discard(bitbuffer_t *bb) {
+
+  assert(bb != NULL);
+
+  if (bb->capacity == 0)
+    return;
+
+  // uncommitted runs may have written anywhere beyond the committed entries
+  // except the word they begin in, so the trailing word is all that needs
+  // restoring
+  bb->words[bb->size / WORD_BITS + (bb->size % WORD_BITS != 0)] = 0;
 }
 
-bool bb_is_empty(const bitbuffer_t *bb) {
+void bb_shrink(bitbuffer_t *bb) {
 
-  // if the buffer is uninitialised, we know it is empty
-  if (bb == NULL || bb->handle == NULL)
-    return true;
+  assert(bb != NULL);
 
-  // synchronise the buffer so we can access bb->buffer_size
-  fflush(bb->handle);
+  if (bb->capacity == 0)
+    return;
 
-  if (bb->buffer_size > 0)
-    return false;
+  // we need the words containing data, plus the trailing word
+  size_t words = bb->size / WORD_BITS + (bb->size % WORD_BITS != 0) + 1;
+  if (words >= bb->capacity)
+    return;
 
-  if (bb->residue_bits > 0)
-    return false;
+  uint64_t *w = realloc(bb->words, words * sizeof(w[0]));
+  if (w == NULL) // tolerable, as we can continue with the larger allocation
+    return;
 
-  return true;
+  bb->words = w;
+  bb->capacity = words;
 }
 
 void bb_reset(bitbuffer_t *bb) {
@@ -130,10 +278,7 @@ void bb_reset(bitbuffer_t *bb) {
   if (bb == NULL)
     return;
 
-  if (bb->handle)
-    (void)fclose(bb->handle);
-
-  free(bb->buffer);
+  free(bb->words);
 
   memset(bb, 0, sizeof(*bb));
 }
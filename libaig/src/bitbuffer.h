@@ -3,28 +3,36 @@
 // The buffer API provided below is intended for storing large arrays of numeric
 // values. Memory occupancy is a concern when there are many of these live at
 // once, so the buffer tightly packs array elements.
+//
+// The read operations (bb_read(), bb_get(), bb_get_range(), bb_is_empty()) are
+// pure memory accesses that never modify the buffer. So any number of threads
+// may read a buffer concurrently, provided none are appending to it at the same
+// time.
 
 #pragma once
 
+#include <assert.h>
+#include <errno.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
-#include <stdio.h>
 
-/// Dynamic buffer. A zeroed out structure is considered initialised, so if the
-/// buffer or handle members are 0, the buffer is considered empty.
+/// Dynamic buffer. A zeroed out structure is considered initialised and empty.
 typedef struct {
 
-  /// Main contents of the buffer. Only coherent after fflushing handle.
-  char *buffer;
-  size_t buffer_size;
+  /// Main contents of the buffer, as a packed little endian bit array. If
+  /// allocated, there is always at least one word beyond the last word
+  /// containing data. Once something has been appended, the words up to and
+  /// including this trailing one are initialised, with any bits beyond size
+  /// being 0. Reserved words past it are uninitialised, so readers must never
+  /// look further than the word following the last entry they read.
+  uint64_t *words;
 
-  /// Handle to write new items to.
-  FILE *handle;
+  /// Number of words allocated in words.
+  size_t capacity;
 
-  /// Bits shorter than a byte that were part of the last append.
-  uint8_t residue;
-  size_t residue_bits;
+  /// Number of bits in use.
+  size_t size;
 
 } bitbuffer_t;
 
@@ -42,6 +50,188 @@ typedef struct {
 __attribute__((visibility("internal")))
 int bb_append(bitbuffer_t *bb, uint64_t value, uint64_t limit);
 
+/** preallocate space for items to be appended to the buffer
+ *
+ * This is an optimisation for when the final number of items is known in
+ * advance. Appends up to that number will then not need to reallocate.
+ *
+ * \param bb Buffer to operate on
+ * \param count Number of items, beyond those already present, to make room for
+ * \param limit Largest item value the buffer ever needs to hold
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int bb_reserve(bitbuffer_t *bb, uint64_t count, uint64_t limit);
+
+/** append a number of items with the value 0 to the buffer
+ *
+ * This is equivalent to, but much faster than, calling bb_append() count times.
+ *
+ * \param bb Buffer to append to
+ * \param count Number of items to append
+ * \param limit Largest item value the buffer ever needs to hold
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int bb_append_zeroes(bitbuffer_t *bb, uint64_t count, uint64_t limit);
+
+/// A run of consecutive items being written into space reserved at the end of
+/// a buffer. Runs covering disjoint ranges may be written concurrently, as each
+/// holds back the words at its ends that it may share with its neighbours until
+/// it is committed.
+typedef struct {
+
+  /// bit offset in the buffer where the run begins
+  size_t start;
+
+  /// bit offset in the buffer just past the last item written
+  size_t size;
+
+  /// contents of the word the run begins in, once the run has moved past it
+  uint64_t first;
+
+  /// contents of the word the run currently ends in
+  uint64_t last;
+
+} bb_run_t;
+
+/** preallocate space for runs of items to be written at the end of the buffer
+ *
+ * This is like bb_reserve(), but also prepares the buffer for the given number
+ * of items to be written via bb_run_append() and bb_run_commit().
+ *
+ * \param bb Buffer to operate on
+ * \param count Number of items, beyond those already present, to make room for
+ * \param limit Largest item value the buffer ever needs to hold
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int bb_run_reserve(bitbuffer_t *bb, uint64_t count, uint64_t limit);
+
+/** start a run of items
+ *
+ * \param run Run to initialise
+ * \param offset Bit offset in the buffer where the run begins
+ */
+static inline void bb_run_start(bb_run_t *run, size_t offset) {
+  assert(run != NULL);
+  *run = (bb_run_t){ .start = offset, .size = offset };
+}
+
+/** write an item at the end of a run
+ *
+ * The item must lie within space previously prepared by bb_run_reserve(). This
+ * only writes to words lying wholly within the run, so it is safe to call
+ * concurrently with writes to other runs.
+ *
+ * \param bb Buffer the run belongs to
+ * \param run Run to extend
+ * \param value Value to write
+ * \param limit Largest item value the buffer ever needs to hold
+ */
+__attribute__((visibility("internal")))
+void bb_run_append(bitbuffer_t *bb, bb_run_t *run, uint64_t value,
+  uint64_t limit);
+
+/** append the items of a run to the buffer
+ *
+ * Runs must be committed one at a time, in order, with each beginning where the
+ * buffer ends. Until as many items as were prepared by bb_run_reserve() have
+ * been committed, the buffer must not be read or appended to. Runs that are
+ * not going to be committed can be abandoned with bb_run_discard().
+ *
+ * \param bb Buffer to commit to
+ * \param run Run to commit
+ */
+__attribute__((visibility("internal")))
+void bb_run_commit(bitbuffer_t *bb, const bb_run_t *run);
+
+/** abandon any uncommitted runs
+ *
+ * After calling this function, the buffer is once again usable, containing
+ * only those items that had been committed.
+ *
+ * \param bb Buffer the runs were being written into
+ */
+__attribute__((visibility("internal")))
+void bb_run_discard(bitbuffer_t *bb);
+
+/** how many bits wide is each item in a buffer?
+ *
+ * \param limit Largest item value the buffer ever needs to hold
+ * \returns The width of each item in bits
+ */
+static inline size_t bb_entry_width(uint64_t limit) {
+
+  if (limit == 0)
+    return 1;
+
+  return sizeof(unsigned long long) * 8 - __builtin_clzll(limit);
+}
+
+/** read raw bits from the buffer
+ *
+ * This is a lower level interface than bb_get(), for callers that manage their
+ * own layout within the buffer. The bits being read must lie within the
+ * buffer.
+ *
+ * \param bb The buffer to read from
+ * \param offset Bit offset to start reading from
+ * \param width Number of bits to read, 1 – 64
+ * \returns The bits read
+ */
+static inline uint64_t bb_read(const bitbuffer_t *bb, size_t offset,
+    size_t width) {
+
+  assert(bb != NULL);
+  assert(width > 0 && width <= 64);
+  assert(offset + width <= bb->size && "out of bounds bit buffer read");
+
+  // read out the bits from the word they start in, and then any part of them
+  // that spills into the following word, which is guaranteed to exist
+  size_t i = offset / 64;
+  size_t o = offset % 64;
+  uint64_t v = (bb->words[i] >> o) | ((bb->words[i + 1] << 1) << (63 - o));
+
+  // discard any bits beyond those requested
+  if (width < 64)
+    v &= (UINT64_C(1) << width) - 1;
+
+  return v;
+}
+
+/** overwrite an item already in the buffer
+ *
+ * Unlike the read operations, this modifies the buffer, so must not be called
+ * concurrently with anything else operating on it.
+ *
+ * \param bb The buffer to write to
+ * \param index Index of the item to overwrite, which must lie within the buffer
+ * \param value Value to write
+ * \param limit Largest item value this buffer ever needs to hold
+ */
+static inline void bb_set(bitbuffer_t *bb, uint64_t index, uint64_t value,
+    uint64_t limit) {
+
+  assert(bb != NULL);
+  assert(value <= limit
+    && "attempt to store an out-of-range value in a bit buffer");
+
+  size_t w = bb_entry_width(limit);
+  assert((index + 1) * w <= bb->size && "out of bounds bit buffer write");
+
+  // replace the bits in the word the item starts in, and then any part of it
+  // that spills into the following word
+  size_t i = index * w / 64;
+  size_t o = index * w % 64;
+  uint64_t mask = w == 64 ? UINT64_MAX : (UINT64_C(1) << w) - 1;
+  bb->words[i] = (bb->words[i] & ~(mask << o)) | (value << o);
+  if (o + w > 64) {
+    uint64_t spilled = (UINT64_C(1) << (o + w - 64)) - 1;
+    bb->words[i + 1] = (bb->words[i + 1] & ~spilled) | (value >> (64 - o));
+  }
+}
+
 /** retrieve an item from the buffer
  *
  * \param bb The buffer to read from
@@ -50,17 +240,60 @@ int bb_append(bitbuffer_t *bb, uint64_t value, uint64_t limit);
  * \param value [out] The value retrieved on success
  * \returns 0 on success or an errno on failure
  */
+static inline int bb_get(const bitbuffer_t *bb, uint64_t index, uint64_t limit,
+    uint64_t *value) {
+
+  assert(bb != NULL);
+  assert(value != NULL);
+
+  size_t w = bb_entry_width(limit);
+
+  // does this entry lie beyond the extent of the buffer?
+  if (index >= bb->size / w)
+    return ERANGE;
+
+  *value = bb_read(bb, index * w, w);
+  return 0;
+}
+
+/** retrieve a contiguous range of items from the buffer
+ *
+ * This is equivalent to, but much faster than, calling bb_get() on each index
+ * in the range.
+ *
+ * \param bb The buffer to read from
+ * \param first Index of the first item to retrieve
+ * \param count Number of items to retrieve
+ * \param limit Largest item value this buffer ever needs to hold
+ * \param values [out] Array of at least count items to write into on success
+ * \returns 0 on success or an errno on failure
+ */
 __attribute__((visibility("internal")))
-int bb_get(const bitbuffer_t *bb, uint64_t index, uint64_t limit,
-  uint64_t *value);
+int bb_get_range(const bitbuffer_t *bb, uint64_t first, uint64_t count,
+  uint64_t limit, uint64_t *values);
 
 /** check if a bit buffer contains nothing
  *
  * \param bb The buffer to check
  * \returns true if empty
  */
+static inline bool bb_is_empty(const bitbuffer_t *bb) {
+
+  // if the buffer is uninitialised, we know it is empty
+  if (bb == NULL)
+    return true;
+
+  return bb->size == 0;
+}
+
+/** release any memory allocated beyond what the buffer’s items occupy
+ *
+ * This is an optimisation for after the final item has been appended.
+ *
+ * \param bb Buffer to operate on
+ */
 __attribute__((visibility("internal")))
-bool bb_is_empty(const bitbuffer_t *bb);
+void bb_shrink(bitbuffer_t *bb);
 
 /** remove all items and clear the state of a buffer
  *
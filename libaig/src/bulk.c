@@ -0,0 +1,206 @@
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <assert.h>
+#include "bitbuffer.h"
+#include "deltabuffer.h"
+#include <errno.h>
+#include "exceptions.h"
+#include "infer.h"
+#include "parse.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// number of AND gates to decode operands for at once
+enum { BLOCK = 256 };
+
+/** check a requested range lies within a node array
+ *
+ * \param first Index of the first node in the range
+ * \param count Number of nodes in the range
+ * \param total Number of nodes in the array
+ * \returns 0 if the range is valid or an errno if not
+ */
+static int check_range(uint64_t first, uint64_t count, uint64_t total) {
+  if (first > total || count > total - first)
+    return ERANGE;
+  return 0;
+}
+
+/** overlay the exceptions within a range onto its inferred values
+ *
+ * \param ex Exceptions to apply
+ * \param first Index of the first node in the range
+ * \param count Number of nodes in the range
+ * \param index_limit Maximum index that can be stored in ex
+ * \param value_limit Maximum value that can be stored in ex
+ * \param values [in,out] Inferred values of the range, to be corrected
+ */
+static void apply_exceptions(const exceptions_t *ex, uint64_t first,
+    uint64_t count, uint64_t index_limit, uint64_t value_limit,
+    uint64_t *values) {
+
+  // the exceptions are sorted, so find the first in range and walk forwards
+  for (size_t i = ex_lower_bound(ex, first, index_limit); i < ex->count; i++) {
+    uint64_t index, value;
+    ex_get(ex, i, index_limit, value_limit, &index, &value);
+    if (index >= first + count)
+      break;
+    values[index - first] = value;
+  }
+}
+
+int aig_get_inputs(aig_t *aig, uint64_t first, uint64_t count,
+    uint64_t *inputs) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (count > 0 && inputs == NULL)
+    return EINVAL;
+
+  int rc = check_range(first, count, aig->input_count);
+  if (rc)
+    return rc;
+
+  if (count == 0)
+    return 0;
+
+  // ensure we have these inputs’ data available
+  if ((rc = parse_inputs(aig, first + count - 1)))
+    return rc;
+
+  // start from the inferred inputs and then correct any that were not
+  for (uint64_t i = 0; i < count; i++)
+    inputs[i] = get_inferred_input(aig, first + i);
+  apply_exceptions(&aig->inputs, first, count, aig->input_count, bb_limit(aig),
+    inputs);
+
+  return 0;
+}
+
+int aig_get_latches(aig_t *aig, uint64_t first, uint64_t count,
+    uint64_t *current, uint64_t *next) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  int rc = check_range(first, count, aig->latch_count);
+  if (rc)
+    return rc;
+
+  if (count == 0)
+    return 0;
+
+  // ensure we have these latches’ data available
+  if ((rc = parse_latches(aig, first + count - 1)))
+    return rc;
+
+  if (current != NULL) {
+    // start from the inferred current values and then correct any that were
+    // not
+    for (uint64_t i = 0; i < count; i++)
+      current[i] = get_inferred_latch_current(aig, first + i);
+    apply_exceptions(&aig->latch_current, first, count, aig->latch_count,
+      bb_limit(aig), current);
+  }
+
+  if (next != NULL) {
+    if ((rc = bb_get_range(&aig->latch_next, first, count, bb_limit(aig),
+        next)))
+      return rc;
+  }
+
+  return 0;
+}
+
+int aig_get_outputs(aig_t *aig, uint64_t first, uint64_t count,
+    uint64_t *outputs) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (count > 0 && outputs == NULL)
+    return EINVAL;
+
+  int rc = check_range(first, count, aig->output_count);
+  if (rc)
+    return rc;
+
+  if (count == 0)
+    return 0;
+
+  // ensure we have these outputs’ data available
+  if ((rc = parse_outputs(aig, first + count - 1)))
+    return rc;
+
+  return bb_get_range(&aig->outputs, first, count, bb_limit(aig), outputs);
+}
+
+int aig_get_ands(aig_t *aig, uint64_t first, uint64_t count, uint64_t *lhs,
+    uint64_t *rhs0, uint64_t *rhs1) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  int rc = check_range(first, count, aig->and_count);
+  if (rc)
+    return rc;
+
+  if (count == 0)
+    return 0;
+
+  // ensure we have these AND gates’ data available
+  if ((rc = parse_ands(aig, first + count - 1)))
+    return rc;
+
+  if (lhs != NULL) {
+    // start from the inferred LHSs and then correct any that were not, which
+    // can only occur in an ASCII AIG
+    for (uint64_t i = 0; i < count; i++)
+      lhs[i] = get_inferred_and_lhs(aig, first + i);
+    apply_exceptions(&aig->and_lhs, first, count, aig->and_count,
+      bb_limit(aig), lhs);
+  }
+
+  // compressed operands are stored relative to their LHS, so decode them one
+  // at a time
+  if (aig->compress && (rhs0 != NULL || rhs1 != NULL)) {
+    for (uint64_t i = 0; i < count; i++) {
+      uint64_t l = lhs != NULL ? lhs[i] : get_and_lhs(aig, first + i);
+      uint64_t r;
+      if (rhs0 != NULL) {
+        if ((rc = db_get(&aig->and_rhs_deltas, (first + i) * 2, l, &r)))
+          return rc;
+        rhs0[i] = r;
+      }
+      if (rhs1 != NULL) {
+        if ((rc = db_get(&aig->and_rhs_deltas, (first + i) * 2 + 1, l, &r)))
+          return rc;
+        rhs1[i] = r;
+      }
+    }
+    return 0;
+  }
+
+  // the operands are stored interleaved, so decode them a block at a time and
+  // then split them out
+  if (rhs0 != NULL || rhs1 != NULL) {
+    for (uint64_t i = 0; i < count; i += BLOCK) {
+
+      uint64_t n = count - i < BLOCK ? count - i : BLOCK;
+      uint64_t rhs[BLOCK * 2];
+      if ((rc = bb_get_range(&aig->and_rhs, (first + i) * 2, n * 2,
+          bb_limit(aig), rhs)))
+        return rc;
+
+      for (uint64_t j = 0; j < n; j++) {
+        if (rhs0 != NULL)
+          rhs0[i + j] = rhs[j * 2];
+        if (rhs1 != NULL)
+          rhs1[i + j] = rhs[j * 2 + 1];
+      }
+    }
+  }
+
+  return 0;
+}
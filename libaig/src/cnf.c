@@ -0,0 +1,183 @@
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <assert.h>
+#include <errno.h>
+#include "sink.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// number of latches or AND gates to decode at once
+enum { BLOCK = 256 };
+
+/// DIMACS variable standing in for the AIG’s constant
+static uint64_t false_variable(const aig_t *aig) {
+  return aig->max_index + 1;
+}
+
+/** write a clause to a sink
+ *
+ * \param aig AIG the literals belong to
+ * \param literals AIG literals to write
+ * \param negate Whether to invert each literal
+ * \param count Number of literals
+ * \param s Output to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int write_clause(const aig_t *aig, const uint64_t *literals,
+    const bool *negate, size_t count, sink_t *s) {
+
+  assert(aig != NULL);
+  assert(s != NULL);
+
+  int rc = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    uint64_t v = literals[i] / 2 == 0 ? false_variable(aig) : literals[i] / 2;
+    bool negative = (literals[i] % 2 != 0) != negate[i];
+    if (negative) {
+      if ((rc = sink_write(s, "-", 1)))
+        return rc;
+    }
+    if ((rc = sink_uint(s, v)))
+      return rc;
+    if ((rc = sink_write(s, " ", 1)))
+      return rc;
+  }
+
+  return sink_write(s, "0\n", 2);
+}
+
+/** write the clauses of an AIG to a sink
+ *
+ * \param aig AIG to translate
+ * \param s Output to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int write_cnf(aig_t *aig, sink_t *s) {
+
+  assert(aig != NULL);
+  assert(s != NULL);
+
+  // one extra variable for the constant, constrained by one unit clause, two
+  // clauses equating each latch to its next state, and three per AND gate
+  if (aig->max_index == UINT64_MAX)
+    return EOVERFLOW;
+  uint64_t variables = aig->max_index + 1;
+  if (aig->and_count > (UINT64_MAX - 1) / 3
+      || aig->latch_count > (UINT64_MAX - 1 - 3 * aig->and_count) / 2)
+    return EOVERFLOW;
+  uint64_t clauses = 1 + 2 * aig->latch_count + 3 * aig->and_count;
+
+  int rc = 0;
+  if ((rc = sink_puts(s, "p cnf ")))
+    return rc;
+  if ((rc = sink_uint(s, variables)))
+    return rc;
+  if ((rc = sink_write(s, " ", 1)))
+    return rc;
+  if ((rc = sink_uint(s, clauses)))
+    return rc;
+  if ((rc = sink_write(s, "\n", 1)))
+    return rc;
+
+  // the constant is false
+  {
+    uint64_t l[] = { 0 };
+    bool neg[] = { true };
+    if ((rc = write_clause(aig, l, neg, 1, s)))
+      return rc;
+  }
+
+  // c = n becomes (¬c ∨ n) ∧ (c ∨ ¬n)
+  for (uint64_t i = 0; i < aig->latch_count; i += BLOCK) {
+    uint64_t n = aig->latch_count - i < BLOCK ? aig->latch_count - i : BLOCK;
+    uint64_t current[BLOCK];
+    uint64_t next[BLOCK];
+    if ((rc = aig_get_latches(aig, i, n, current, next)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      uint64_t l[] = { current[j], next[j] };
+      if ((rc = write_clause(aig, l, (bool[]){ true, false }, 2, s)))
+        return rc;
+      if ((rc = write_clause(aig, l, (bool[]){ false, true }, 2, s)))
+        return rc;
+    }
+  }
+
+  // x = a ∧ b becomes (¬x ∨ a) ∧ (¬x ∨ b) ∧ (x ∨ ¬a ∨ ¬b)
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint64_t lhs[BLOCK];
+    uint64_t rhs0[BLOCK];
+    uint64_t rhs1[BLOCK];
+    if ((rc = aig_get_ands(aig, i, n, lhs, rhs0, rhs1)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      uint64_t l0[] = { lhs[j], rhs0[j] };
+      if ((rc = write_clause(aig, l0, (bool[]){ true, false }, 2, s)))
+        return rc;
+      uint64_t l1[] = { lhs[j], rhs1[j] };
+      if ((rc = write_clause(aig, l1, (bool[]){ true, false }, 2, s)))
+        return rc;
+      uint64_t l2[] = { lhs[j], rhs0[j], rhs1[j] };
+      if ((rc = write_clause(aig, l2, (bool[]){ false, true, true }, 3, s)))
+        return rc;
+    }
+  }
+
+  return 0;
+}
+
+int aig_to_cnf_file(aig_t *aig, FILE *f) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (f == NULL)
+    return EINVAL;
+
+  sink_t s;
+  int rc = sink_open(&s, f);
+  if (rc)
+    return rc;
+
+  if ((rc = write_cnf(aig, &s))) {
+    (void)sink_close(&s);
+    return rc;
+  }
+
+  return sink_close(&s);
+}
+
+int aig_to_cnf_string(aig_t *aig, char **cnf) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (cnf == NULL)
+    return EINVAL;
+
+  // create a buffer to write the CNF representation into
+  char *out = NULL;
+  size_t out_size = 0;
+  FILE *f = open_memstream(&out, &out_size);
+  if (f == NULL)
+    return errno;
+
+  // delegate to the FILE interface
+  int rc = aig_to_cnf_file(aig, f);
+
+  // finalise the buffer
+  fclose(f);
+
+  if (rc) {
+    free(out);
+    return rc;
+  }
+
+  *cnf = out;
+  return 0;
+}
@@ -0,0 +1,445 @@
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <assert.h>
+#include <errno.h>
+#include "node_map.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "topo.h"
+
+/// is a variable set in a bitset?
+static bool is_set(const uint64_t *bits, uint64_t variable_index) {
+  return (bits[variable_index / 64] >> (variable_index % 64)) & 1;
+}
+
+/// set a variable in a bitset
+static void set(uint64_t *bits, uint64_t variable_index) {
+  bits[variable_index / 64] |= UINT64_C(1) << (variable_index % 64);
+}
+
+/// a stack of variables whose fanins are yet to be marked
+typedef struct {
+  uint64_t *items;
+  size_t size;
+  size_t capacity;
+} worklist_t;
+
+static int push(worklist_t *s, uint64_t variable_index) {
+
+  assert(s != NULL);
+
+  if (s->size == s->capacity) {
+    size_t c = s->capacity == 0 ? 64 : s->capacity * 2;
+    if (c < s->capacity || SIZE_MAX / sizeof(s->items[0]) < c)
+      return ENOMEM;
+    uint64_t *i = realloc(s->items, c * sizeof(i[0]));
+    if (i == NULL)
+      return ENOMEM;
+    s->items = i;
+    s->capacity = c;
+  }
+
+  s->items[s->size++] = variable_index;
+  return 0;
+}
+
+/** mark a variable, queueing it if it was not already marked
+ *
+ * \param aig AIG being searched
+ * \param bits Bitset of marked variables
+ * \param stack Variables yet to be expanded
+ * \param variable_index Variable to mark
+ * \returns 0 on success or an errno on failure
+ */
+static int reach(const aig_t *aig, uint64_t *bits, worklist_t *stack,
+    uint64_t variable_index) {
+
+  assert(aig != NULL);
+  assert(bits != NULL);
+
+  if (variable_index > aig->max_index)
+    return ERANGE;
+
+  if (is_set(bits, variable_index))
+    return 0;
+
+  set(bits, variable_index);
+  return push(stack, variable_index);
+}
+
+/** find the node that defines a variable
+ *
+ * \param aig AIG to search
+ * \param variable_index Variable to lookup
+ * \param type [out] Type of the defining node on success, AIG_INPUT for a
+ *   variable that nothing defines, or AIG_CONSTANT for variable 0
+ * \param index [out] Index of the defining node within its type, if any
+ * \returns 0 on success or an errno on failure
+ */
+static int find_node(aig_t *aig, uint64_t variable_index,
+    enum aig_node_type *type, uint64_t *index) {
+
+  assert(aig != NULL);
+  assert(type != NULL);
+  assert(index != NULL);
+
+  if (variable_index == 0) {
+    *type = AIG_CONSTANT;
+    return 0;
+  }
+
+  int rc = node_map_find(aig, variable_index, type, index);
+
+  // a variable that nothing defines is a free input
+  if (rc == ERANGE) {
+    *type = AIG_INPUT;
+    return 0;
+  }
+
+  return rc;
+}
+
+/** mark the cone of influence of some literals
+ *
+ * \param aig AIG to search
+ * \param literals Literals whose cone to mark
+ * \param count Number of entries in literals
+ * \param sequential Whether to continue through latches to their next states
+ * \param bits Bitset to mark variables in, initially empty
+ * \returns 0 on success or an errno on failure
+ */
+static int mark(aig_t *aig, const uint64_t *literals, size_t count,
+    bool sequential, uint64_t *bits) {
+
+  assert(aig != NULL);
+  assert(literals != NULL || count == 0);
+  assert(bits != NULL);
+
+  int rc = 0;
+  worklist_t stack = {0};
+
+  for (size_t i = 0; i < count; i++) {
+    if ((rc = reach(aig, bits, &stack, literals[i] / 2)))
+      goto done;
+  }
+
+  while (stack.size > 0) {
+    uint64_t v = stack.items[--stack.size];
+
+    enum aig_node_type type;
+    uint64_t index;
+    if ((rc = find_node(aig, v, &type, &index)))
+      goto done;
+
+    if (type == AIG_AND_GATE) {
+      struct aig_node n;
+      if ((rc = aig_get_and(aig, index, &n)))
+        goto done;
+      if ((rc = reach(aig, bits, &stack, n.and_gate.rhs[0])))
+        goto done;
+      if ((rc = reach(aig, bits, &stack, n.and_gate.rhs[1])))
+        goto done;
+    }
+
+    if (type == AIG_LATCH && sequential) {
+      struct aig_node n;
+      if ((rc = aig_get_latch_no_symbol(aig, index, &n)))
+        goto done;
+      if ((rc = reach(aig, bits, &stack, n.latch.next)))
+        goto done;
+    }
+  }
+
+done:
+  free(stack.items);
+
+  return rc;
+}
+
+/** allocate an empty bitset with room for every variable in an AIG
+ *
+ * \param aig AIG whose variables to size for
+ * \param bits [out] Allocated bitset on success
+ * \returns 0 on success or an errno on failure
+ */
+static int new_bitset(const aig_t *aig, uint64_t **bits) {
+
+  assert(aig != NULL);
+  assert(bits != NULL);
+
+  if (aig->max_index > SIZE_MAX - 64)
+    return ENOMEM;
+
+  uint64_t *b = calloc(aig->max_index / 64 + 1, sizeof(b[0]));
+  if (b == NULL)
+    return ENOMEM;
+
+  *bits = b;
+  return 0;
+}
+
+int aig_cone(aig_t *aig, const uint64_t *literals, size_t count,
+    bool sequential, uint64_t **cone) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (literals == NULL && count > 0)
+    return EINVAL;
+
+  if (cone == NULL)
+    return EINVAL;
+
+  uint64_t *bits = NULL;
+  int rc = new_bitset(aig, &bits);
+  if (rc)
+    return rc;
+
+  if ((rc = mark(aig, literals, count, sequential, bits))) {
+    free(bits);
+    return rc;
+  }
+
+  *cone = bits;
+  return 0;
+}
+
+/// translate a literal into the numbering of an extracted cone
+static uint64_t renumber(const uint64_t *numbers, uint64_t literal) {
+  return numbers[literal / 2] * 2 + literal % 2;
+}
+
+/** assign variable indices to the nodes of a cone of influence
+ *
+ * Inputs and latches are numbered first in order of their original variables,
+ * followed by AND gates in the given order. Latches are turned into inputs
+ * when the cone is combinational, as are variables that nothing defines.
+ *
+ * \param aig AIG the cone was taken from
+ * \param sequential Whether latches were followed
+ * \param bits Variables in the cone
+ * \param gates AND gates in the cone, in topological order
+ * \param gate_count Number of entries in gates
+ * \param numbers [out] New variable index of each variable in the cone, or 0
+ *   for none
+ * \param inputs [out] Number of inputs in the cone on success
+ * \param latches [out] Number of latches in the cone on success
+ * \returns 0 on success or an errno on failure
+ */
+static int number_cone(aig_t *aig, bool sequential, const uint64_t *bits,
+    const uint64_t *gates, uint64_t gate_count, uint64_t *numbers,
+    uint64_t *inputs, uint64_t *latches) {
+
+  assert(aig != NULL);
+  assert(bits != NULL);
+  assert(gates != NULL || gate_count == 0);
+  assert(numbers != NULL);
+  assert(inputs != NULL);
+  assert(latches != NULL);
+
+  int rc = 0;
+  *inputs = 0;
+  *latches = 0;
+
+  // number inputs and then latches
+  for (int pass = 0; pass < 2; pass++) {
+    for (uint64_t v = 1; v <= aig->max_index; v++) {
+      if (!is_set(bits, v))
+        continue;
+
+      enum aig_node_type type;
+      uint64_t index;
+      if ((rc = find_node(aig, v, &type, &index)))
+        return rc;
+
+      bool latch = type == AIG_LATCH && sequential;
+      bool input = type == AIG_INPUT || (type == AIG_LATCH && !sequential);
+      if (pass == 0 && input) {
+        numbers[v] = ++*inputs;
+      } else if (pass == 1 && latch) {
+        numbers[v] = *inputs + ++*latches;
+      }
+    }
+  }
+
+  // number AND gates in an order where their operands come first
+  for (uint64_t i = 0; i < gate_count; i++) {
+    struct aig_node n;
+    if ((rc = aig_get_and(aig, gates[i], &n)))
+      return rc;
+    numbers[n.and_gate.lhs] = *inputs + *latches + i + 1;
+  }
+
+  return 0;
+}
+
+/** fill an empty AIG with a numbered cone of influence
+ *
+ * Every node of the cone is numbered in sequence by number_cone(), so each sits
+ * at its inferred position and no exceptions need recording. Only the latch
+ * next states, outputs and AND gate operands are stored.
+ *
+ * \param aig AIG the cone was taken from
+ * \param literals Literals to become the outputs of the cone
+ * \param count Number of entries in literals
+ * \param bits Variables in the cone
+ * \param gates AND gates in the cone, in topological order
+ * \param numbers New variable index of each variable, from number_cone()
+ * \param c AIG to fill, with its header counts already set
+ * \returns 0 on success or an errno on failure
+ */
+static int build_cone(aig_t *aig, const uint64_t *literals, size_t count,
+    const uint64_t *bits, const uint64_t *gates, const uint64_t *numbers,
+    aig_t *c) {
+
+  assert(aig != NULL);
+  assert(bits != NULL);
+  assert(numbers != NULL);
+  assert(c != NULL);
+
+  int rc = 0;
+
+  if ((rc = bb_reserve(&c->latch_next, c->latch_count, bb_limit(c))))
+    return rc;
+  if ((rc = bb_reserve(&c->outputs, c->output_count, bb_limit(c))))
+    return rc;
+  if (!c->compress) {
+    if ((rc = bb_reserve(&c->and_rhs, c->and_count * 2, bb_limit(c))))
+      return rc;
+  }
+
+  // latches, in the order number_cone() numbered them
+  for (uint64_t v = 1; v <= aig->max_index; v++) {
+    if (!is_set(bits, v) || numbers[v] <= c->input_count
+        || numbers[v] > c->input_count + c->latch_count)
+      continue;
+
+    enum aig_node_type type;
+    uint64_t index;
+    if ((rc = find_node(aig, v, &type, &index)))
+      return rc;
+    assert(type == AIG_LATCH);
+
+    struct aig_node n;
+    if ((rc = aig_get_latch_no_symbol(aig, index, &n)))
+      return rc;
+    uint64_t next = n.latch.next * 2 + (n.latch.next_negated ? 1 : 0);
+    if ((rc = bb_append(&c->latch_next, renumber(numbers, next), bb_limit(c))))
+      return rc;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    if ((rc = bb_append(&c->outputs, renumber(numbers, literals[i]),
+        bb_limit(c))))
+      return rc;
+  }
+
+  for (uint64_t i = 0; i < c->and_count; i++) {
+    struct aig_node n;
+    if ((rc = aig_get_and(aig, gates[i], &n)))
+      return rc;
+
+    uint64_t lhs = numbers[n.and_gate.lhs] * 2;
+    uint64_t rhs0 = renumber(numbers, n.and_gate.rhs[0] * 2
+                                      + (n.and_gate.negated[0] ? 1 : 0));
+    uint64_t rhs1 = renumber(numbers, n.and_gate.rhs[1] * 2
+                                      + (n.and_gate.negated[1] ? 1 : 0));
+
+    // store the operands as parsing would, relative to the LHS in compressed
+    // mode
+    if (c->compress) {
+      if ((rc = db_append(&c->and_rhs_deltas, lhs, rhs0)))
+        return rc;
+      if ((rc = db_append(&c->and_rhs_deltas, lhs, rhs1)))
+        return rc;
+    } else {
+      if ((rc = bb_append(&c->and_rhs, rhs0, bb_limit(c))))
+        return rc;
+      if ((rc = bb_append(&c->and_rhs, rhs1, bb_limit(c))))
+        return rc;
+    }
+  }
+
+  if (c->compress)
+    db_shrink(&c->and_rhs_deltas);
+
+  return 0;
+}
+
+int aig_cone_extract(aig_t *aig, const uint64_t *literals, size_t count,
+    bool sequential, aig_t **cone) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (literals == NULL && count > 0)
+    return EINVAL;
+
+  if (cone == NULL)
+    return EINVAL;
+
+  uint64_t *bits = NULL;
+  int rc = new_bitset(aig, &bits);
+  if (rc)
+    return rc;
+
+  if ((rc = mark(aig, literals, count, sequential, bits))) {
+    free(bits);
+    return rc;
+  }
+
+  if (aig->max_index > SIZE_MAX / sizeof(uint64_t) - 1) {
+    free(bits);
+    return ENOMEM;
+  }
+
+  // order only the gates in the cone, so cycles elsewhere do not matter
+  uint64_t *gates = NULL;
+  uint64_t gate_count = 0;
+  uint64_t *numbers = NULL;
+  uint64_t inputs, latches;
+  aig_t *c = NULL;
+  if ((rc = topo_sort_subset(aig, bits, &gates, &gate_count)))
+    goto done;
+
+  numbers = calloc(aig->max_index + 1, sizeof(numbers[0]));
+  if (numbers == NULL) {
+    rc = ENOMEM;
+    goto done;
+  }
+
+  if ((rc = number_cone(aig, sequential, bits, gates, gate_count, numbers,
+      &inputs, &latches)))
+    goto done;
+
+  // construct the extracted AIG as if it had been fully parsed
+  if ((rc = aig_new(&c, (struct aig_options){ 0 })))
+    goto done;
+  c->max_index = inputs + latches + gate_count;
+  c->input_count = inputs;
+  c->latch_count = latches;
+  c->output_count = count;
+  c->and_count = gate_count;
+  c->eager = true;
+  c->compress = aig->compress;
+  c->threads = aig->threads;
+  c->state = DONE;
+
+  rc = build_cone(aig, literals, count, bits, gates, numbers, c);
+
+done:
+  free(numbers);
+  free(gates);
+  free(bits);
+
+  if (rc) {
+    if (c != NULL)
+      aig_free(&c);
+    return rc;
+  }
+
+  *cone = c;
+  return 0;
+}
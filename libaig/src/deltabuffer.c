@@ -0,0 +1,160 @@
+#include <assert.h>
+#include "bitbuffer.h"
+#include "deltabuffer.h"
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// map a (wrapping) difference to an unsigned value, such that differences of
+// small magnitude in either direction become small values
+static uint64_t zigzag(uint64_t delta) {
+  return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+// inverse of zigzag()
+static uint64_t unzigzag(uint64_t z) {
+  return (z >> 1) ^ (0 - (z & 1));
+}
+
+// the limit to pass to bit buffer functions for a given entry width
+static uint64_t width_limit(size_t width) {
+  assert(width > 0 && width <= 64);
+  return width == 64 ? UINT64_MAX : (UINT64_C(1) << width) - 1;
+}
+
+// move the pending entries into a complete block
+static int flush(deltabuffer_t *db) {
+
+  assert(db != NULL);
+  assert(db->pending_count == DB_BLOCK);
+
+  // make room for another block header
+  if (db->blocks == db->capacity) {
+    size_t c = db->capacity == 0 ? 16 : db->capacity * 2;
+    if (c < db->capacity)
+      return ENOMEM;
+
+    uint64_t *o = realloc(db->offsets, c * sizeof(o[0]));
+    if (o == NULL)
+      return ENOMEM;
+    db->offsets = o;
+
+    uint8_t *w = realloc(db->widths, c * sizeof(w[0]));
+    if (w == NULL)
+      return ENOMEM;
+    db->widths = w;
+
+    db->capacity = c;
+  }
+
+  // the block is stored at the width of its largest entry
+  uint64_t largest = 0;
+  for (size_t i = 0; i < DB_BLOCK; i++) {
+    if (db->pending[i] > largest)
+      largest = db->pending[i];
+  }
+  size_t width = bb_entry_width(largest);
+  uint64_t limit = width_limit(width);
+
+  // make room for the whole block before writing any of it, so a failure
+  // leaves the buffer unmodified; reserve in proportion to the existing data
+  // to amortise growth
+  int rc = bb_reserve(&db->data, DB_BLOCK + db->data.size / width, limit);
+  if (rc)
+    return rc;
+
+  size_t offset = db->data.size;
+  for (size_t i = 0; i < DB_BLOCK; i++) {
+    rc = bb_append(&db->data, db->pending[i], limit);
+    assert(rc == 0 && "append failed despite reserved space");
+  }
+
+  db->offsets[db->blocks] = offset;
+  db->widths[db->blocks] = (uint8_t)width;
+  ++db->blocks;
+  db->pending_count = 0;
+
+  return 0;
+}
+
+int db_append(deltabuffer_t *db, uint64_t base, uint64_t value) {
+
+  assert(db != NULL);
+  assert(db->pending_count < DB_BLOCK);
+
+  db->pending[db->pending_count] = zigzag(base - value);
+  ++db->pending_count;
+
+  if (db->pending_count == DB_BLOCK) {
+    int rc = flush(db);
+    if (rc) {
+      --db->pending_count;
+      return rc;
+    }
+  }
+
+  return 0;
+}
+
+int db_get(const deltabuffer_t *db, uint64_t index, uint64_t base,
+    uint64_t *value) {
+
+  assert(db != NULL);
+  assert(value != NULL);
+
+  uint64_t block = index / DB_BLOCK;
+  uint64_t offset = index % DB_BLOCK;
+
+  uint64_t z;
+  if (block < db->blocks) {
+    size_t width = db->widths[block];
+    z = bb_read(&db->data, db->offsets[block] + offset * width, width);
+  } else if (block == db->blocks && offset < db->pending_count) {
+    z = db->pending[offset];
+  } else {
+    return ERANGE;
+  }
+
+  *value = base - unzigzag(z);
+  return 0;
+}
+
+void db_shrink(deltabuffer_t *db) {
+
+  assert(db != NULL);
+
+  bb_shrink(&db->data);
+
+  // failure to shrink the block headers is tolerable, as we can continue with
+  // the larger allocations
+  if (db->blocks > 0 && db->blocks < db->capacity) {
+    uint64_t *o = realloc(db->offsets, db->blocks * sizeof(o[0]));
+    if (o == NULL)
+      return;
+    db->offsets = o;
+
+    uint8_t *w = realloc(db->widths, db->blocks * sizeof(w[0]));
+    if (w == NULL) {
+      // offsets has shrunk, so we can no longer use the extra capacity
+      db->capacity = db->blocks;
+      return;
+    }
+    db->widths = w;
+
+    db->capacity = db->blocks;
+  }
+}
+
+void db_reset(deltabuffer_t *db) {
+
+  if (db == NULL)
+    return;
+
+  bb_reset(&db->data);
+  free(db->offsets);
+  free(db->widths);
+
+  memset(db, 0, sizeof(*db));
+}
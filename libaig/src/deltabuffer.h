@@ -0,0 +1,85 @@
+// abstraction for a dynamically expanding buffer of values stored relative to a
+// base
+//
+// In practice, the operands of an AND gate tend to be numerically close to the
+// gate itself. So rather than storing each operand at the full width needed
+// for any variable, this buffer stores the difference between each value and a
+// caller-supplied base (the gate’s LHS). Entries are grouped into fixed size
+// blocks, each packed at the width of its largest difference. A small header
+// per block records where the block starts and its width, so random access
+// remains O(1).
+//
+// Like bit buffers, the read operations are pure memory accesses. So concurrent
+// readers are safe, provided none are appending at the same time.
+
+#pragma once
+
+#include "bitbuffer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// number of entries in each block of a delta buffer
+enum { DB_BLOCK = 64 };
+
+/// Dynamic buffer of deltas. A zeroed out structure is considered initialised
+/// and empty.
+typedef struct {
+
+  /// packed deltas of all complete blocks
+  bitbuffer_t data;
+
+  /// bit offset within data at which each complete block starts
+  uint64_t *offsets;
+
+  /// bit width of the entries within each complete block
+  uint8_t *widths;
+
+  /// number of complete blocks
+  size_t blocks;
+
+  /// number of blocks allocated in offsets and widths
+  size_t capacity;
+
+  /// deltas of the trailing incomplete block, zigzag encoded
+  uint64_t pending[DB_BLOCK];
+
+  /// number of entries in pending
+  size_t pending_count;
+
+} deltabuffer_t;
+
+/** append an item to the buffer
+ *
+ * \param db Buffer to append to
+ * \param base Value to store this item relative to
+ * \param value Value to append
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int db_append(deltabuffer_t *db, uint64_t base, uint64_t value);
+
+/** retrieve an item from the buffer
+ *
+ * \param db The buffer to read from
+ * \param index Index of the item to retrieve
+ * \param base Value the item was stored relative to
+ * \param value [out] The value retrieved on success
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int db_get(const deltabuffer_t *db, uint64_t index, uint64_t base,
+  uint64_t *value);
+
+/** release any memory allocated beyond what the buffer’s items occupy
+ *
+ * \param db Buffer to operate on
+ */
+__attribute__((visibility("internal")))
+void db_shrink(deltabuffer_t *db);
+
+/** remove all items and clear the state of a buffer
+ *
+ * \param db The buffer to operate on
+ */
+__attribute__((visibility("internal")))
+void db_reset(deltabuffer_t *db);
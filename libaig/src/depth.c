@@ -0,0 +1,309 @@
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <assert.h>
+#include <errno.h>
+#include "fanout.h"
+#include "infer.h"
+#include "level.h"
+#include "node_map.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/// marker for a variable from which no output or latch next state is reachable
+#define NO_DEPTH UINT32_MAX
+
+/// number of nodes to decode at once
+enum { BLOCK = 256 };
+
+/** mark every variable that is an output or latch next state with depth 0
+ *
+ * \param aig AIG to read from
+ * \param depths Depth of every variable, initially NO_DEPTH
+ * \param sink_level [out] Greatest level of any marked variable on success
+ * \returns 0 on success or an errno on failure
+ */
+static int mark_sinks(aig_t *aig, uint32_t *depths, uint32_t *sink_level) {
+
+  assert(aig != NULL);
+  assert(aig->levels != NULL);
+  assert(depths != NULL);
+  assert(sink_level != NULL);
+
+  int rc = 0;
+  uint32_t deepest = 0;
+
+  for (uint64_t i = 0; i < aig->output_count; i += BLOCK) {
+    uint64_t n = aig->output_count - i < BLOCK ? aig->output_count - i : BLOCK;
+    uint64_t o[BLOCK];
+    if ((rc = aig_get_outputs(aig, i, n, o)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      depths[o[j] / 2] = 0;
+      if (aig->levels[o[j] / 2] > deepest)
+        deepest = aig->levels[o[j] / 2];
+    }
+  }
+
+  for (uint64_t i = 0; i < aig->latch_count; i += BLOCK) {
+    uint64_t n = aig->latch_count - i < BLOCK ? aig->latch_count - i : BLOCK;
+    uint64_t next[BLOCK];
+    if ((rc = aig_get_latches(aig, i, n, NULL, next)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      depths[next[j] / 2] = 0;
+      if (aig->levels[next[j] / 2] > deepest)
+        deepest = aig->levels[next[j] / 2];
+    }
+  }
+
+  *sink_level = deepest;
+  return 0;
+}
+
+/** compute the depth of every variable into aig->depths
+ *
+ * Variables are visited in decreasing level order, so every fanout of a
+ * variable is final by the time we reach it. The depth of each is then the
+ * greatest depth of its fanouts plus one.
+ *
+ * \param aig AIG to operate on
+ * \returns 0 on success or an errno on failure
+ */
+static int compute_depths(aig_t *aig) {
+
+  assert(aig != NULL);
+
+  if (aig->depths != NULL)
+    return 0;
+
+  int rc = levelize(aig);
+  if (rc)
+    return rc;
+
+  if ((rc = fanout_build(aig)))
+    return rc;
+
+  size_t size = (size_t)aig->max_index + 1;
+  if (size > SIZE_MAX / sizeof(uint64_t))
+    return ENOMEM;
+
+  uint32_t *depths = malloc(size * sizeof(depths[0]));
+  uint64_t *order = malloc(size * sizeof(order[0]));
+  uint64_t *offsets = NULL;
+  uint64_t *live = NULL;
+  if (depths == NULL || order == NULL) {
+    rc = ENOMEM;
+    goto done;
+  }
+
+  if ((rc = node_map_first_ands(aig, &live)))
+    goto done;
+
+  for (size_t v = 0; v < size; v++)
+    depths[v] = NO_DEPTH;
+
+  uint32_t sink_level;
+  if ((rc = mark_sinks(aig, depths, &sink_level)))
+    goto done;
+
+  // counting sort the variables by level
+  uint32_t deepest = 0;
+  for (size_t v = 0; v < size; v++) {
+    if (aig->levels[v] > deepest)
+      deepest = aig->levels[v];
+  }
+  offsets = calloc((size_t)deepest + 2, sizeof(offsets[0]));
+  if (offsets == NULL) {
+    rc = ENOMEM;
+    goto done;
+  }
+  for (size_t v = 0; v < size; v++)
+    ++offsets[aig->levels[v] + 1];
+  for (size_t l = 0; l <= deepest; l++)
+    offsets[l + 1] += offsets[l];
+  for (size_t v = 0; v < size; v++)
+    order[offsets[aig->levels[v]]++] = v;
+
+  // pull depths back from fanouts, deepest variables first
+  for (size_t i = size; i > 0; i--) {
+    uint64_t v = order[i - 1];
+    for (uint64_t j = fanout_offset(aig, v); j < fanout_offset(aig, v + 1);
+         j++) {
+      uint64_t position = fanout_position(fanout_edge(aig, j));
+
+      // a path ends at a latch’s next state, which mark_sinks() has handled
+      if (position < aig->latch_count)
+        continue;
+      uint64_t g = position - aig->latch_count;
+      if (!((live[g / 64] >> (g % 64)) & 1))
+        continue;
+      uint64_t w = get_and_lhs(aig, g) / 2;
+      if (depths[w] == NO_DEPTH)
+        continue;
+      if (depths[v] == NO_DEPTH || depths[w] + 1 > depths[v])
+        depths[v] = depths[w] + 1;
+    }
+  }
+
+  aig->depths = depths;
+  depths = NULL;
+  aig->sink_level = sink_level;
+
+done:
+  free(live);
+  free(offsets);
+  free(order);
+  free(depths);
+
+  return rc;
+}
+
+/** find the variable whose depth a node has
+ *
+ * \param node Node to examine
+ * \returns The node’s variable index
+ */
+static uint64_t variable_index(const struct aig_node *node) {
+  assert(node != NULL);
+  switch (node->type) {
+    case AIG_CONSTANT: return 0;
+    case AIG_INPUT:    return node->input.variable_index;
+    case AIG_LATCH:    return node->latch.current;
+    case AIG_OUTPUT:   return node->output.variable_index;
+    case AIG_AND_GATE: return node->and_gate.lhs;
+  }
+  __builtin_unreachable();
+}
+
+int aig_node_depth(aig_t *aig, const struct aig_node *node, size_t *depth) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (node == NULL)
+    return EINVAL;
+
+  if (depth == NULL)
+    return EINVAL;
+
+  // does this node have an invalid index (inconsistent AIG)?
+  uint64_t v = variable_index(node);
+  if (v > aig->max_index)
+    return ERANGE;
+
+  int rc = compute_depths(aig);
+  if (rc)
+    return rc;
+
+  if (aig->depths[v] == NO_DEPTH)
+    return ENOENT;
+
+  *depth = aig->depths[v];
+  return 0;
+}
+
+int aig_node_slack(aig_t *aig, const struct aig_node *node, size_t *slack) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (node == NULL)
+    return EINVAL;
+
+  if (slack == NULL)
+    return EINVAL;
+
+  // does this node have an invalid index (inconsistent AIG)?
+  uint64_t v = variable_index(node);
+  if (v > aig->max_index)
+    return ERANGE;
+
+  int rc = compute_depths(aig);
+  if (rc)
+    return rc;
+
+  if (aig->depths[v] == NO_DEPTH)
+    return ENOENT;
+
+  // every path through this node ends at a variable no deeper than the
+  // deepest sink, so this cannot underflow
+  uint64_t length = (uint64_t)aig->levels[v] + aig->depths[v];
+  assert(length <= aig->sink_level);
+  *slack = (size_t)(aig->sink_level - length);
+  return 0;
+}
+
+int aig_levels(aig_t *aig, const uint32_t **levels) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (levels == NULL)
+    return EINVAL;
+
+  int rc = levelize(aig);
+  if (rc)
+    return rc;
+
+  *levels = aig->levels;
+  return 0;
+}
+
+int aig_depths(aig_t *aig, const uint32_t **depths) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (depths == NULL)
+    return EINVAL;
+
+  int rc = compute_depths(aig);
+  if (rc)
+    return rc;
+
+  *depths = aig->depths;
+  return 0;
+}
+
+int aig_critical_variables(aig_t *aig, uint64_t **variables, size_t *count) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (variables == NULL)
+    return EINVAL;
+
+  if (count == NULL)
+    return EINVAL;
+
+  int rc = compute_depths(aig);
+  if (rc)
+    return rc;
+
+  size_t size = (size_t)aig->max_index + 1;
+
+  // a variable is critical if the longest path through it is as long as any
+  size_t n = 0;
+  for (size_t v = 0; v < size; v++) {
+    if (aig->depths[v] != NO_DEPTH
+        && (uint64_t)aig->levels[v] + aig->depths[v] == aig->sink_level)
+      ++n;
+  }
+
+  uint64_t *vs = malloc((n == 0 ? 1 : n) * sizeof(vs[0]));
+  if (vs == NULL)
+    return ENOMEM;
+
+  n = 0;
+  for (size_t v = 0; v < size; v++) {
+    if (aig->depths[v] != NO_DEPTH
+        && (uint64_t)aig->levels[v] + aig->depths[v] == aig->sink_level)
+      vs[n++] = v;
+  }
+
+  *variables = vs;
+  *count = n;
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include <assert.h>
+#include "bitbuffer.h"
+#include "exceptions.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+int ex_append(exceptions_t *ex, uint64_t index, uint64_t value,
+    uint64_t index_limit, uint64_t value_limit) {
+
+  assert(ex != NULL);
+
+#ifndef NDEBUG
+  // exceptions must be appended in order
+  if (ex->count > 0) {
+    uint64_t last, v;
+    ex_get(ex, ex->count - 1, index_limit, value_limit, &last, &v);
+    assert(index > last && "out of order exception");
+  }
+#endif
+
+  // make room for the value first, so that once the index is appended the
+  // value append cannot fail and leave the two buffers out of sync
+  int rc = bb_reserve(&ex->values, 1, value_limit);
+  if (rc)
+    return rc;
+
+  if ((rc = bb_append(&ex->indices, index, index_limit)))
+    return rc;
+
+  rc = bb_append(&ex->values, value, value_limit);
+  assert(rc == 0 && "append failed despite reservation");
+
+  ++ex->count;
+
+  return 0;
+}
+
+int ex_reserve(exceptions_t *ex, size_t count, uint64_t index_limit,
+    uint64_t value_limit) {
+
+  assert(ex != NULL);
+
+  int rc = bb_reserve(&ex->indices, count, index_limit);
+  if (rc)
+    return rc;
+
+  return bb_reserve(&ex->values, count, value_limit);
+}
+
+size_t ex_lower_bound(const exceptions_t *ex, uint64_t index,
+    uint64_t index_limit) {
+
+  assert(ex != NULL);
+
+  size_t width = bb_entry_width(index_limit);
+
+  size_t low = 0;
+  size_t high = ex->count;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (bb_read(&ex->indices, mid * width, width) < index) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+void ex_get(const exceptions_t *ex, size_t position, uint64_t index_limit,
+    uint64_t value_limit, uint64_t *index, uint64_t *value) {
+
+  assert(ex != NULL);
+  assert(position < ex->count);
+  assert(index != NULL);
+  assert(value != NULL);
+
+  size_t iw = bb_entry_width(index_limit);
+  size_t vw = bb_entry_width(value_limit);
+
+  *index = bb_read(&ex->indices, position * iw, iw);
+  *value = bb_read(&ex->values, position * vw, vw);
+}
+
+bool ex_find(const exceptions_t *ex, uint64_t index, uint64_t index_limit,
+    uint64_t value_limit, uint64_t *value) {
+
+  assert(ex != NULL);
+  assert(value != NULL);
+
+  // fast path for the common case of there being no exceptions at all
+  if (ex->count == 0)
+    return false;
+
+  size_t position = ex_lower_bound(ex, index, index_limit);
+  if (position == ex->count)
+    return false;
+
+  uint64_t i;
+  ex_get(ex, position, index_limit, value_limit, &i, value);
+  return i == index;
+}
+
+void ex_reset(exceptions_t *ex) {
+
+  if (ex == NULL)
+    return;
+
+  bb_reset(&ex->indices);
+  bb_reset(&ex->values);
+
+  memset(ex, 0, sizeof(*ex));
+}
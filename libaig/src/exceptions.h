@@ -0,0 +1,100 @@
+// abstraction for the few entries of an otherwise inferable sequence that do
+// not follow the inferred pattern
+//
+// Exceptions are stored as (index, value) pairs in two bit buffers. They must
+// be appended in increasing index order, which keeps them sorted and lets
+// lookups binary search.
+
+#pragma once
+
+#include "bitbuffer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// List of exceptions. A zeroed out structure is considered initialised and
+/// empty.
+typedef struct {
+
+  /// index of each exception, in increasing order
+  bitbuffer_t indices;
+
+  /// value of each exception
+  bitbuffer_t values;
+
+  /// number of exceptions
+  size_t count;
+
+} exceptions_t;
+
+/** append an exception
+ *
+ * \param ex List to append to
+ * \param index Index of the exception, which must exceed any prior index
+ * \param value Value of the exception
+ * \param index_limit Maximum index that can be stored
+ * \param value_limit Maximum value that can be stored
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int ex_append(exceptions_t *ex, uint64_t index, uint64_t value,
+  uint64_t index_limit, uint64_t value_limit);
+
+/** preallocate space for exceptions to be appended
+ *
+ * Appends up to the given number will then not fail.
+ *
+ * \param ex List to operate on
+ * \param count Number of exceptions, beyond those already present, to make
+ *   room for
+ * \param index_limit Maximum index that can be stored
+ * \param value_limit Maximum value that can be stored
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int ex_reserve(exceptions_t *ex, size_t count, uint64_t index_limit,
+  uint64_t value_limit);
+
+/** find the position of the first exception at or after a given index
+ *
+ * \param ex List to search
+ * \param index Index to search for
+ * \param index_limit Maximum index that can be stored
+ * \returns Position of the exception, or ex->count if there is none
+ */
+__attribute__((visibility("internal")))
+size_t ex_lower_bound(const exceptions_t *ex, uint64_t index,
+  uint64_t index_limit);
+
+/** retrieve the exception at a given position
+ *
+ * \param ex List to read from
+ * \param position Position of the exception, less than ex->count
+ * \param index_limit Maximum index that can be stored
+ * \param value_limit Maximum value that can be stored
+ * \param index [out] Index of the exception
+ * \param value [out] Value of the exception
+ */
+__attribute__((visibility("internal")))
+void ex_get(const exceptions_t *ex, size_t position, uint64_t index_limit,
+  uint64_t value_limit, uint64_t *index, uint64_t *value);
+
+/** lookup the exception for a given index
+ *
+ * \param ex List to search
+ * \param index Index to lookup
+ * \param index_limit Maximum index that can be stored
+ * \param value_limit Maximum value that can be stored
+ * \param value [out] Value of the exception if found
+ * \returns True if there was an exception for this index
+ */
+__attribute__((visibility("internal")))
+bool ex_find(const exceptions_t *ex, uint64_t index, uint64_t index_limit,
+  uint64_t value_limit, uint64_t *value);
+
+/** remove all exceptions and clear the state of a list
+ *
+ * \param ex The list to operate on
+ */
+__attribute__((visibility("internal")))
+void ex_reset(exceptions_t *ex);
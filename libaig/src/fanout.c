@@ -1,38 +1,128 @@
 #include <aig/aig.h>
 #include "aig_t.h"
 #include <assert.h>
+#include "bitbuffer.h"
 #include <errno.h>
-#include <limits.h>
+#include "fanout.h"
 #include "node_iter.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
-static bool is_fanout(const struct aig_node *n, uint64_t predecessor) {
+/// number of latches or AND gates to decode at once when indexing
+enum { BLOCK = 256 };
+
+/** record a fanout edge
+ *
+ * \param aig AIG whose fanout index is being built
+ * \param filling False when counting each variable’s edges, true when filling
+ *   them in using the offsets as write cursors
+ * \param predecessor Encoded fanin of the edge
+ * \param edge Encoded edge
+ */
+static void add_edge(aig_t *aig, bool filling, uint64_t predecessor,
+    uint64_t edge) {
+
+  uint64_t v = predecessor / 2;
+  uint64_t limit = fanout_offset_limit(aig);
+
+  if (!filling) {
+    uint64_t count = fanout_offset(aig, v + 1);
+    bb_set(&aig->fanout_offsets, v + 1, count + 1, limit);
+  } else {
+    uint64_t cursor = fanout_offset(aig, v);
+    bb_set(&aig->fanout_edges, cursor, edge, fanout_edge_limit(aig));
+    bb_set(&aig->fanout_offsets, v, cursor + 1, limit);
+  }
+}
+
+/** make a pass over every latch and AND gate, counting or filling edges
+ *
+ * \param aig AIG to read from and whose fanout index is being built
+ * \param filling Whether to fill edges rather than count them
+ * \returns 0 on success or an errno on failure
+ */
+static int scan(aig_t *aig, bool filling) {
+
+  assert(aig != NULL);
+
+  int rc = 0;
+
+  for (uint64_t i = 0; i < aig->latch_count; i += BLOCK) {
+    uint64_t n = aig->latch_count - i < BLOCK ? aig->latch_count - i : BLOCK;
+    uint64_t next[BLOCK];
+    if ((rc = aig_get_latches(aig, i, n, NULL, next)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++)
+      add_edge(aig, filling, next[j], (i + j) << 1);
+  }
 
-  assert(n != NULL);
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint64_t rhs0[BLOCK];
+    uint64_t rhs1[BLOCK];
+    if ((rc = aig_get_ands(aig, i, n, NULL, rhs0, rhs1)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      uint64_t position = aig->latch_count + i + j;
+      add_edge(aig, filling, rhs0[j], position << 1);
+      add_edge(aig, filling, rhs1[j], (position << 1) | 1);
+    }
+  }
 
-  switch (n->type) {
+  return 0;
+}
+
+int fanout_build(aig_t *aig) {
 
-    case AIG_LATCH:
-      if (n->latch.next == predecessor)
-        return true;
-      break;
+  assert(aig != NULL);
 
-    case AIG_AND_GATE:
-      if (n->and_gate.rhs[0] == predecessor)
-        return true;
-      if (n->and_gate.rhs[1] == predecessor)
-        return true;
-      break;
+  if (fanout_is_built(aig))
+    return 0;
 
-    default:
-      // do nothing
-      break;
+  bitbuffer_t *offsets = &aig->fanout_offsets;
+  uint64_t limit = fanout_offset_limit(aig);
+
+  if (aig->max_index > UINT64_MAX - 2)
+    return ENOMEM;
 
+  int rc = bb_append_zeroes(offsets, aig->max_index + 2, limit);
+  if (rc)
+    return rc;
+
+  // first pass: count the fanouts of each variable
+  if ((rc = scan(aig, false)))
+    goto fail;
+
+  // accumulate these, so entry v is the start of v’s edges and entry v + 1 is
+  // the end
+  uint64_t total = 0;
+  for (uint64_t v = 0; v <= aig->max_index + 1; v++) {
+    total += fanout_offset(aig, v);
+    bb_set(offsets, v, total, limit);
   }
 
-  return false;
+  if ((rc = bb_append_zeroes(&aig->fanout_edges, total,
+      fanout_edge_limit(aig))))
+    goto fail;
+
+  // second pass: fill in the edges, using each variable’s start as a cursor,
+  // which leaves entry v at the end of v’s edges
+  if ((rc = scan(aig, true)))
+    goto fail;
+
+  // shift the cursors back into place as starts
+  for (uint64_t v = aig->max_index + 1; v > 0; v--)
+    bb_set(offsets, v, fanout_offset(aig, v - 1), limit);
+  bb_set(offsets, 0, 0, limit);
+
+  return 0;
+
+fail:
+  bb_reset(&aig->fanout_edges);
+  bb_reset(offsets);
+  return rc;
 }
 
 static uint64_t variable_index(const struct aig_node *node) {
@@ -47,37 +137,41 @@ static uint64_t variable_index(const struct aig_node *node) {
   __builtin_unreachable();
 }
 
-static int advance_to_next(aig_node_iter_t *it) {
+int fanout_range(aig_t *aig, const struct aig_node *node, uint64_t *begin,
+    uint64_t *end) {
 
-  assert(it != NULL);
-  assert(it->state != NULL);
+  assert(aig != NULL);
+  assert(node != NULL);
+  assert(begin != NULL);
+  assert(end != NULL);
 
-  aig_t *aig = it->aig;
-  int rc = 0;
-  uint64_t predecessor = *(uint64_t*)it->state;
+  int rc = fanout_build(aig);
+  if (rc)
+    return rc;
 
-  while (it->index < aig->latch_count + aig->and_count) {
+  // a variable beyond the maximum cannot be used by anything
+  uint64_t v = variable_index(node);
+  if (v > aig->max_index) {
+    *begin = *end = 0;
+    return 0;
+  }
 
-    // extract the current node
-    struct aig_node n;
-    if (it->index < aig->latch_count) {
-      rc = aig_get_latch(aig, it->index, &n);
-    } else {
-      uint64_t index = it->index - aig->latch_count;
-      rc = aig_get_and(aig, index, &n);
-    }
+  *begin = fanout_offset(aig, v);
+  *end = fanout_offset(aig, v + 1);
+  return 0;
+}
 
-    if (rc)
-      return rc;
+/// state of a fanout iterator
+typedef struct {
 
-    if (is_fanout(&n, predecessor))
-      break;
+  /// index one past the last edge to iterate over
+  uint64_t end;
 
-    ++it->index;
-  }
+  /// pins through which the node last yielded uses the iterator’s node, or 0 if
+  /// none has been yielded yet
+  unsigned pins;
 
-  return 0;
-}
+} fanout_state_t;
 
 static int next(aig_node_iter_t *it, struct aig_node *item) {
 
@@ -89,25 +183,31 @@ static int next(aig_node_iter_t *it, struct aig_node *item) {
     return EINVAL;
 
   aig_t *aig = it->aig;
-  int rc = 0;
+  fanout_state_t *state = it->state;
 
   // extract the current node
+  uint64_t position = fanout_position(fanout_edge(aig, it->index));
   struct aig_node n;
-  if (it->index < aig->latch_count) {
-    rc = aig_get_latch(aig, it->index, &n);
+  int rc = 0;
+  if (position < aig->latch_count) {
+    rc = aig_get_latch(aig, position, &n);
   } else {
-    uint64_t index = it->index - aig->latch_count;
-    rc = aig_get_and(aig, index, &n);
+    rc = aig_get_and(aig, position - aig->latch_count, &n);
   }
 
   if (rc)
     return rc;
 
-  // move to the next valid node
-  ++it->index;
-  if ((rc = advance_to_next(it)))
-    return rc;
+  // collect the pins of every edge from this node, moving to the next distinct
+  // node
+  unsigned pins = 0;
+  do {
+    pins |= 1u << fanout_pin(fanout_edge(aig, it->index));
+    ++it->index;
+  } while (it->index < state->end
+        && fanout_position(fanout_edge(aig, it->index)) == position);
 
+  state->pins = pins;
   *item = n;
   return rc;
 }
@@ -119,10 +219,9 @@ static bool has_next(const aig_node_iter_t *it) {
   if (it->aig == NULL)
     return false;
 
-  const aig_t *aig = it->aig;
-
-  // if the current index is out of range, we are exhausted
-  if (it->index >= aig->latch_count + aig->and_count)
+  // if the current edge is out of range, we are exhausted
+  const fanout_state_t *state = it->state;
+  if (it->index >= state->end)
     return false;
 
   // otherwise, there is more to consume
@@ -130,7 +229,7 @@ static bool has_next(const aig_node_iter_t *it) {
 }
 
 static void fanout_free(aig_node_iter_t *it) {
-  // clean up the predecessor index we saved
+  // clean up the state we saved
   free(it->state);
   it->state = NULL;
 }
@@ -147,10 +246,15 @@ int aig_iter_fanout(aig_t *aig, const struct aig_node *node,
   if (it == NULL)
     return EINVAL;
 
+  // find this node’s fanout edges
+  uint64_t begin, end;
+  int rc = fanout_range(aig, node, &begin, &end);
+  if (rc)
+    return rc;
+
   // create a new iterator;
   aig_node_iter_t *i = NULL;
-  int rc = aig_iter(aig, &i);
-  if (rc)
+  if ((rc = aig_iter(aig, &i)))
     return rc;
 
   // override the next-finding mechanism with our own
@@ -158,22 +262,38 @@ int aig_iter_fanout(aig_t *aig, const struct aig_node *node,
   i->next = next;
   i->free = fanout_free;
 
-  // save the predecessor index within the iterator
-  uint64_t index = variable_index(node);
-  i->state = calloc(1, sizeof(uint64_t));
-  if (i->state == NULL) {
+  // iterate over the edges, saving where to stop within the iterator
+  i->index = begin;
+  fanout_state_t *state = calloc(1, sizeof(*state));
+  if (state == NULL) {
     aig_iter_free(&i);
     return ENOMEM;
   }
-  *(uint64_t*)i->state = index;
-
-  // advance until we hit a valid fanout or exhaust the nodes
-  if ((rc = advance_to_next(i))) {
-    aig_iter_free(&i);
-    return rc;
-  }
+  state->end = end;
+  i->state = state;
 
   *it = i;
 
   return 0;
 }
+
+int aig_iter_fanout_pins(const aig_node_iter_t *it, unsigned *pins) {
+
+  if (it == NULL)
+    return EINVAL;
+
+  if (pins == NULL)
+    return EINVAL;
+
+  // is this not a fanout iterator?
+  if (it->next != next)
+    return EINVAL;
+
+  // has nothing been yielded yet?
+  const fanout_state_t *state = it->state;
+  if (state->pins == 0)
+    return EINVAL;
+
+  *pins = state->pins;
+  return 0;
+}
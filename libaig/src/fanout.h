@@ -0,0 +1,152 @@
+// abstraction for finding the nodes that take a given variable as an input
+//
+// The fanouts of every variable are indexed at once, in compressed sparse row
+// form. Each edge is encoded as the position of the fanout node, counting
+// through latches and then AND gates, with the fanin pin it uses in the low
+// bit. A latch only has one pin, its next state. Offsets and edges are packed
+// into bit buffers only as wide as the AIG’s size needs.
+
+#pragma once
+
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <assert.h>
+#include "bitbuffer.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** construct the fanout index of an AIG
+ *
+ * This parses every latch and AND gate if they have not already been parsed.
+ * Calling this on an AIG whose index is already built is a no-op.
+ *
+ * \param aig AIG to operate on
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int fanout_build(aig_t *aig);
+
+/** release the fanout index of an AIG
+ *
+ * The index is rebuilt by the next fanout_build().
+ *
+ * \param aig AIG to operate on
+ */
+static inline void fanout_discard(aig_t *aig) {
+  assert(aig != NULL);
+  bb_reset(&aig->fanout_offsets);
+  bb_reset(&aig->fanout_edges);
+}
+
+/** has the fanout index of an AIG been built?
+ *
+ * \param aig AIG to examine
+ * \returns True if the index exists
+ */
+static inline bool fanout_is_built(const aig_t *aig) {
+  assert(aig != NULL);
+  // a built index always has at least the offsets of variable 0
+  return !bb_is_empty(&aig->fanout_offsets);
+}
+
+/** get the limit value of the fanout offsets
+ *
+ * \param aig AIG whose fanout index to use
+ * \returns Limit value for use with bb_get() on aig->fanout_offsets
+ */
+static inline uint64_t fanout_offset_limit(const aig_t *aig) {
+  assert(aig != NULL);
+  // every latch has one edge and every AND gate two
+  return aig->latch_count + aig->and_count * 2;
+}
+
+/** get the limit value of the fanout edges
+ *
+ * \param aig AIG whose fanout index to use
+ * \returns Limit value for use with bb_get() on aig->fanout_edges
+ */
+static inline uint64_t fanout_edge_limit(const aig_t *aig) {
+  assert(aig != NULL);
+  return ((aig->latch_count + aig->and_count) << 1) | 1;
+}
+
+/** get the start of a variable’s fanout edges
+ *
+ * \param aig AIG whose fanout index to use, which must be built
+ * \param variable_index Variable to lookup, up to aig->max_index + 1 to find
+ *   the end of the previous variable’s edges
+ * \returns Index of the variable’s first edge
+ */
+static inline uint64_t fanout_offset(const aig_t *aig,
+    uint64_t variable_index) {
+  assert(fanout_is_built(aig));
+  size_t w = bb_entry_width(fanout_offset_limit(aig));
+  return bb_read(&aig->fanout_offsets, variable_index * w, w);
+}
+
+/** get a fanout edge
+ *
+ * \param aig AIG whose fanout index to use, which must be built
+ * \param index Index of the edge
+ * \returns The encoded edge
+ */
+static inline uint64_t fanout_edge(const aig_t *aig, uint64_t index) {
+  assert(fanout_is_built(aig));
+  size_t w = bb_entry_width(fanout_edge_limit(aig));
+  return bb_read(&aig->fanout_edges, index * w, w);
+}
+
+/** find the range of fanout edges of a node
+ *
+ * This builds the fanout index if it does not already exist. The edges of the
+ * node are then fanout_edge(aig, begin) up to fanout_edge(aig, end).
+ *
+ * \param aig AIG whose fanout index to use
+ * \param node Node whose fanouts to find
+ * \param begin [out] Index of the first edge
+ * \param end [out] Index one past the last edge
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int fanout_range(aig_t *aig, const struct aig_node *node, uint64_t *begin,
+  uint64_t *end);
+
+/** get the position of the fanout node of a fanout edge
+ *
+ * \param edge Edge to decode
+ * \returns Position of the node, counting latches then AND gates
+ */
+static inline uint64_t fanout_position(uint64_t edge) {
+  return edge >> 1;
+}
+
+/** get the fanin pin of a fanout edge
+ *
+ * \param edge Edge to decode
+ * \returns 0 for a latch’s next state or AND gate’s first operand, 1 for an AND
+ *   gate’s second operand
+ */
+static inline unsigned fanout_pin(uint64_t edge) {
+  return (unsigned)(edge & 1);
+}
+
+/** skip past any further edges from the same fanout node
+ *
+ * An AND gate that uses a variable for both of its operands has two edges from
+ * it, but is only one fanout.
+ *
+ * \param aig AIG whose fanout index to use
+ * \param index Index of the edge after the one just consumed
+ * \param end Index one past the last edge
+ * \param position Position of the fanout node just consumed
+ * \returns Index of the next edge from a different node
+ */
+static inline uint64_t fanout_skip(const aig_t *aig, uint64_t index,
+    uint64_t end, uint64_t position) {
+
+  // edges are filled in node order, so duplicates are adjacent
+  while (index < end && fanout_position(fanout_edge(aig, index)) == position)
+    ++index;
+
+  return index;
+}
@@ -0,0 +1,202 @@
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <assert.h>
+#include <errno.h>
+#include "fanout.h"
+#include "infer.h"
+#include "node_map.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/// number of outputs to decode at once
+enum { BLOCK = 256 };
+
+/** add the variables fed by a variable to a cone
+ *
+ * \param aig AIG whose fanout index to use
+ * \param variable_index Variable whose fanouts to add
+ * \param sequential Whether to continue through latches
+ * \param live AND gates that are the first definition of their variable
+ * \param cone Bitset of variables in the cone
+ * \param word Word of cone currently being swept
+ * \param behind [in,out] Lowest word below word changed so far
+ */
+static void expand(const aig_t *aig, uint64_t variable_index, bool sequential,
+    const uint64_t *live, uint64_t *cone, uint64_t word, uint64_t *behind) {
+
+  assert(aig != NULL);
+  assert(fanout_is_built(aig));
+  assert(cone != NULL);
+  assert(behind != NULL);
+
+  for (uint64_t i = fanout_offset(aig, variable_index);
+       i < fanout_offset(aig, variable_index + 1); i++) {
+    uint64_t position = fanout_position(fanout_edge(aig, i));
+
+    uint64_t v;
+    if (position < aig->latch_count) {
+      if (!sequential)
+        continue;
+      v = get_latch_current(aig, position) / 2;
+    } else {
+      // a gate that only redefines an earlier node’s variable affects nothing
+      uint64_t g = position - aig->latch_count;
+      if (!((live[g / 64] >> (g % 64)) & 1))
+        continue;
+      v = get_and_lhs(aig, g) / 2;
+    }
+
+    cone[v / 64] |= UINT64_C(1) << (v % 64);
+    if (v / 64 < word && v / 64 < *behind)
+      *behind = v / 64;
+  }
+}
+
+/** mark the transitive fanout of a set of variables
+ *
+ * The cone itself serves as the frontier: any variable marked in it but not
+ * yet in expanded has fanouts still to add. We sweep upwards a word at a time,
+ * skipping words with nothing pending. In a topologically ordered AIG every
+ * fanout lies above its fanin, so one sweep suffices. Otherwise a fanout that
+ * lands below the sweep causes another sweep from there.
+ *
+ * \param aig AIG whose fanout index to use
+ * \param sequential Whether to continue through latches
+ * \param live AND gates that are the first definition of their variable
+ * \param cone Bitset of variables in the cone, initially the seeds
+ * \param expanded Bitset of variables whose fanouts have been added,
+ *   initially empty
+ * \param words Number of words in each bitset
+ * \param lowest Lowest word containing a seed
+ */
+static void mark(const aig_t *aig, bool sequential, const uint64_t *live,
+    uint64_t *cone, uint64_t *expanded, size_t words, uint64_t lowest) {
+
+  assert(aig != NULL);
+  assert(cone != NULL);
+  assert(expanded != NULL);
+
+  while (lowest < words) {
+    uint64_t start = lowest;
+    lowest = UINT64_MAX;
+
+    for (uint64_t w = start; w < words; w++) {
+      uint64_t pending;
+      while ((pending = cone[w] & ~expanded[w]) != 0) {
+        unsigned bit = (unsigned)__builtin_ctzll(pending);
+        expanded[w] |= UINT64_C(1) << bit;
+        expand(aig, w * 64 + bit, sequential, live, cone, w, &lowest);
+      }
+    }
+  }
+}
+
+/** find the outputs whose values are in a cone
+ *
+ * \param aig AIG to examine
+ * \param cone Bitset of variables in the cone
+ * \param outputs [out] Indices of the affected outputs on success
+ * \param output_count [out] Number of entries in outputs on success
+ * \returns 0 on success or an errno on failure
+ */
+static int affected_outputs(aig_t *aig, const uint64_t *cone,
+    uint64_t **outputs, size_t *output_count) {
+
+  assert(aig != NULL);
+  assert(cone != NULL);
+  assert(outputs != NULL);
+  assert(output_count != NULL);
+
+  if (aig->output_count > SIZE_MAX / sizeof(uint64_t))
+    return ENOMEM;
+
+  uint64_t *os = malloc((aig->output_count == 0 ? 1 : aig->output_count)
+                        * sizeof(os[0]));
+  if (os == NULL)
+    return ENOMEM;
+
+  size_t n = 0;
+  for (uint64_t i = 0; i < aig->output_count; i += BLOCK) {
+    uint64_t m = aig->output_count - i < BLOCK ? aig->output_count - i : BLOCK;
+    uint64_t o[BLOCK];
+    int rc = aig_get_outputs(aig, i, m, o);
+    if (rc) {
+      free(os);
+      return rc;
+    }
+    for (uint64_t j = 0; j < m; j++) {
+      uint64_t v = o[j] / 2;
+      if ((cone[v / 64] >> (v % 64)) & 1)
+        os[n++] = i + j;
+    }
+  }
+
+  *outputs = os;
+  *output_count = n;
+  return 0;
+}
+
+int aig_fanout_cone(aig_t *aig, const uint64_t *variables, size_t count,
+    bool sequential, uint64_t **cone, uint64_t **outputs,
+    size_t *output_count) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (variables == NULL && count > 0)
+    return EINVAL;
+
+  if (cone == NULL)
+    return EINVAL;
+
+  if (outputs != NULL && output_count == NULL)
+    return EINVAL;
+
+  int rc = fanout_build(aig);
+  if (rc)
+    return rc;
+
+  size_t words = (size_t)(aig->max_index / 64 + 1);
+  uint64_t *c = calloc(words, sizeof(c[0]));
+  uint64_t *expanded = calloc(words, sizeof(expanded[0]));
+  uint64_t *live = NULL;
+  if (c == NULL || expanded == NULL) {
+    rc = ENOMEM;
+    goto done;
+  }
+
+  if ((rc = node_map_first_ands(aig, &live)))
+    goto done;
+
+  // seed the cone
+  uint64_t lowest = UINT64_MAX;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t v = variables[i];
+    if (v > aig->max_index) {
+      rc = ERANGE;
+      goto done;
+    }
+    c[v / 64] |= UINT64_C(1) << (v % 64);
+    if (v / 64 < lowest)
+      lowest = v / 64;
+  }
+
+  mark(aig, sequential, live, c, expanded, words, lowest);
+
+  if (outputs != NULL) {
+    if ((rc = affected_outputs(aig, c, outputs, output_count)))
+      goto done;
+  }
+
+  *cone = c;
+  c = NULL;
+
+done:
+  free(live);
+  free(expanded);
+  free(c);
+
+  return rc;
+}
@@ -1,7 +1,13 @@
 #include <aig/aig.h>
 #include "aig_t.h"
 #include <errno.h>
+#include "fanout.h"
+#include "parallel.h"
+#include "parse.h"
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 int aig_fanout_count(aig_t *aig, const struct aig_node *node, size_t *count) {
 
@@ -14,25 +20,140 @@ int aig_fanout_count(aig_t *aig, const struct aig_node *node, size_t *count) {
   if (count == NULL)
     return EINVAL;
 
+  // find the fanout edges of this node
+  uint64_t begin, end;
+  int rc = fanout_range(aig, node, &begin, &end);
+  if (rc)
+    return rc;
+
+  // count the distinct nodes among them
+  size_t c = 0;
+  for (uint64_t i = begin; i < end; ++c) {
+    uint64_t position = fanout_position(fanout_edge(aig, i));
+    i = fanout_skip(aig, i + 1, end, position);
+  }
+
+  *count = c;
+  return 0;
+}
+
+/// number of nodes to decode at once
+enum { BLOCK = 256 };
+
+/// number of AND gates each task counts references from
+enum { TASK_SIZE = 1 << 16 };
+
+/// state shared between threads counting references
+typedef struct {
+  aig_t *aig;
+  size_t *counts;
+  bool atomic;
+} counts_t;
+
+/** count a reference to a variable
+ *
+ * \param cs Counting state
+ * \param literal Encoded reference
+ */
+static void add_reference(const counts_t *cs, uint64_t literal) {
+  size_t *c = &cs->counts[literal / 2];
+  if (cs->atomic) {
+    (void)__atomic_fetch_add(c, 1, __ATOMIC_RELAXED);
+  } else {
+    ++*c;
+  }
+}
+
+/** count the references from a range of AND gates
+ *
+ * \param arg Counting state
+ * \param task Index of the range of AND gates to count
+ * \returns 0 on success or an errno on failure
+ */
+static int count_ands(void *arg, size_t task) {
+
+  const counts_t *cs = arg;
+  aig_t *aig = cs->aig;
+
+  uint64_t first = (uint64_t)task * TASK_SIZE;
+  uint64_t last = aig->and_count - first < TASK_SIZE ? aig->and_count
+                                                     : first + TASK_SIZE;
+
+  for (uint64_t i = first; i < last; i += BLOCK) {
+    uint64_t n = last - i < BLOCK ? last - i : BLOCK;
+    uint64_t rhs0[BLOCK];
+    uint64_t rhs1[BLOCK];
+    int rc = aig_get_ands(aig, i, n, NULL, rhs0, rhs1);
+    if (rc)
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      add_reference(cs, rhs0[j]);
+      add_reference(cs, rhs1[j]);
+    }
+  }
+
+  return 0;
+}
+
+int aig_fanout_counts(aig_t *aig, bool latches, bool outputs, size_t *counts) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (counts == NULL)
+    return EINVAL;
+
   int rc = 0;
 
-  // create a fanout iterator
-  aig_node_iter_t *it = NULL;
-  if ((rc = aig_iter_fanout(aig, node, &it)))
+  // parse everything we need upfront, so the AIG is only read from here on and
+  // can be shared between threads
+  if ((rc = parse_ands(aig, UINT64_MAX)))
     return rc;
 
-  // iterate through all nodes, counting the total
-  size_t c = 0;
-  while (aig_iter_has_next(it)) {
-    ++c;
-    struct aig_node ignored;
-    if ((rc = aig_iter_next(it, &ignored)))
+  size_t size = (size_t)aig->max_index + 1;
+  if (size > SIZE_MAX / sizeof(counts[0]))
+    return ENOMEM;
+
+  memset(counts, 0, size * sizeof(counts[0]));
+
+  uint64_t tasks = aig->and_count / TASK_SIZE
+                 + (aig->and_count % TASK_SIZE != 0);
+  counts_t cs = { .aig = aig, .counts = counts };
+
+  if (aig->threads > 1 && tasks > 1) {
+    cs.atomic = true;
+    if ((rc = parallel_for(aig->threads, (size_t)tasks, count_ands, &cs)))
       return rc;
+    cs.atomic = false;
+  } else {
+    for (uint64_t i = 0; i < tasks; i++) {
+      if ((rc = count_ands(&cs, (size_t)i)))
+        return rc;
+    }
   }
 
-  // clean up the iterator
-  aig_iter_free(&it);
+  if (latches) {
+    for (uint64_t i = 0; i < aig->latch_count; i += BLOCK) {
+      uint64_t n = aig->latch_count - i < BLOCK ? aig->latch_count - i : BLOCK;
+      uint64_t next[BLOCK];
+      if ((rc = aig_get_latches(aig, i, n, NULL, next)))
+        return rc;
+      for (uint64_t j = 0; j < n; j++)
+        add_reference(&cs, next[j]);
+    }
+  }
+
+  if (outputs) {
+    for (uint64_t i = 0; i < aig->output_count; i += BLOCK) {
+      uint64_t n = aig->output_count - i < BLOCK ? aig->output_count - i
+                                                 : BLOCK;
+      uint64_t o[BLOCK];
+      if ((rc = aig_get_outputs(aig, i, n, o)))
+        return rc;
+      for (uint64_t j = 0; j < n; j++)
+        add_reference(&cs, o[j]);
+    }
+  }
 
-  *count = c;
   return 0;
 }
@@ -1,7 +1,10 @@
 #include <aig/aig.h>
 #include "aig_t.h"
 #include "bitbuffer.h"
+#include "deltabuffer.h"
+#include "exceptions.h"
 #include "infer.h"
+#include "source.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -14,12 +17,14 @@ void aig_free(aig_t **aig) {
 
   aig_t *a = *aig;
 
-  bb_reset(&a->inputs);
-  bb_reset(&a->latch_current);
+  ex_reset(&a->inputs);
+  ex_reset(&a->latch_current);
   bb_reset(&a->latch_next);
   bb_reset(&a->outputs);
-  bb_reset(&a->and_lhs);
+  ex_reset(&a->and_lhs);
   bb_reset(&a->and_rhs);
+  db_reset(&a->and_rhs_deltas);
+  ex_reset(&a->node_map);
 
   if (a->symtab != NULL) {
     size_t sz = get_symtab_size(a);
@@ -34,9 +39,21 @@ void aig_free(aig_t **aig) {
   free(a->levels);
   a->levels = NULL;
 
-  if (a->source != NULL)
-    (void)fclose(a->source);
-  a->source = NULL;
+  free(a->level_offsets);
+  a->level_offsets = NULL;
+  free(a->level_gates);
+  a->level_gates = NULL;
+
+  free(a->depths);
+  a->depths = NULL;
+
+  free(a->topo_order);
+  a->topo_order = NULL;
+
+  bb_reset(&a->fanout_offsets);
+  bb_reset(&a->fanout_edges);
+
+  source_close(&a->source);
 
   free(*aig);
   *aig = NULL;
@@ -1,7 +1,7 @@
 #include <aig/aig.h>
 #include "aig_t.h"
 #include <assert.h>
-#include "bitbuffer.h"
+#include "exceptions.h"
 #include "infer.h"
 #include <stddef.h>
 #include <stdint.h>
@@ -15,17 +15,12 @@ uint64_t get_inferred_input(const aig_t *aig, uint64_t index) {
 uint64_t get_input(const aig_t *aig, uint64_t index) {
   assert(aig != NULL);
 
-  // if the AIG has no inputs data, the input was deemed inferable
-  if (bb_is_empty(&aig->inputs))
-    return get_inferred_input(aig, index);
+  // if the input was recorded as an exception, it was not inferable
+  uint64_t input = 0;
+  if (ex_find(&aig->inputs, index, aig->input_count, bb_limit(aig), &input))
+    return input;
 
-  // otherwise it should be in the input array;
-  uint64_t input;
-  int rc __attribute__((unused))
-    = bb_get(&aig->inputs, index, bb_limit(aig), &input);
-  assert(rc == 0);
-
-  return input;
+  return get_inferred_input(aig, index);
 }
 
 uint64_t get_inferred_latch_current(const aig_t *aig, uint64_t index) {
@@ -36,18 +31,13 @@ uint64_t get_inferred_latch_current(const aig_t *aig, uint64_t index) {
 uint64_t get_latch_current(const aig_t *aig, uint64_t index) {
   assert(aig != NULL);
 
-  // if the AIG has no latch current data, the current value was deemed
-  // inferable
-  if (bb_is_empty(&aig->latch_current))
-    return get_inferred_latch_current(aig, index);
-
-  // otherwise it should be in the latch current array;
-  uint64_t current;
-  int rc __attribute__((unused))
-    = bb_get(&aig->latch_current, index, bb_limit(aig), &current);
-  assert(rc == 0);
+  // if the current value was recorded as an exception, it was not inferable
+  uint64_t current = 0;
+  if (ex_find(&aig->latch_current, index, aig->latch_count, bb_limit(aig),
+      &current))
+    return current;
 
-  return current;
+  return get_inferred_latch_current(aig, index);
 }
 
 uint64_t get_inferred_and_lhs(const aig_t *aig, uint64_t index) {
@@ -58,17 +48,12 @@ uint64_t get_inferred_and_lhs(const aig_t *aig, uint64_t index) {
 uint64_t get_and_lhs(const aig_t *aig, uint64_t index) {
   assert(aig != NULL);
 
-  // if the AIG has no LHS data, the LHS was deemed inferable
-  if (bb_is_empty(&aig->and_lhs))
-    return get_inferred_and_lhs(aig, index);
-
-  // otherwise it should be in the LHS array
-  uint64_t lhs;
-  int rc __attribute__((unused))
-    = bb_get(&aig->and_lhs, index, bb_limit(aig), &lhs);
-  assert(rc == 0);
+  // if the LHS was recorded as an exception, it was not inferable
+  uint64_t lhs = 0;
+  if (ex_find(&aig->and_lhs, index, aig->and_count, bb_limit(aig), &lhs))
+    return lhs;
 
-  return lhs;
+  return get_inferred_and_lhs(aig, index);
 }
 
 size_t get_symtab_size(const aig_t *aig) {
@@ -2,26 +2,533 @@
 #include "aig_t.h"
 #include <assert.h>
 #include <errno.h>
+#include "fanout.h"
+#include "infer.h"
+#include "level.h"
+#include "parallel.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
-static size_t max(size_t a, size_t b) {
-  if (a > b)
-    return a;
-  return b;
+/// marker for a variable whose level has not yet been computed
+#define UNVISITED UINT32_MAX
+
+/// marker for a variable whose level is being computed
+#define ON_STACK (UINT32_MAX - 1)
+
+/// number of AND gates to decode at once
+enum { BLOCK = 256 };
+
+/// is this a variable whose level is known?
+static bool is_known(uint32_t level) {
+  return level != UNVISITED && level != ON_STACK;
 }
 
-static int cache_level(aig_t *aig, size_t index, size_t level) {
+/** find the fanins of a variable
+ *
+ * \param aig AIG to read from
+ * \param variable_index Variable to examine
+ * \param fanins [out] Variable indices of the fanins on success
+ * \param count [out] Number of fanins on success
+ * \returns 0 on success or an errno on failure
+ */
+static int get_fanins(aig_t *aig, uint64_t variable_index, uint64_t fanins[2],
+    size_t *count) {
+
   assert(aig != NULL);
-  assert(index <= aig->max_index);
+  assert(count != NULL);
+
+  *count = 0;
+
+  struct aig_node n;
+  int rc = aig_get_node_no_symbol(aig, variable_index, &n);
+
+  // a variable that nothing defines is treated as a base node
+  if (rc == ERANGE)
+    return 0;
+  if (rc)
+    return rc;
+
+  switch (n.type) {
+
+    case AIG_AND_GATE:
+      fanins[0] = n.and_gate.rhs[0];
+      fanins[1] = n.and_gate.rhs[1];
+      *count = 2;
+      break;
+
+    // constants, inputs, and latches are all base nodes, the last because a
+    // latch’s next state only reaches it in the following cycle
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+/** compute the level of a node from those of its fanins
+ *
+ * \param levels Levels of every variable, including the fanins
+ * \param fanins Variable indices of the fanins
+ * \param count Number of fanins
+ * \param level [out] Level of the node on success
+ * \returns 0 on success or an errno on failure
+ */
+static int combine(const uint32_t *levels, const uint64_t *fanins, size_t count,
+    uint32_t *level) {
+
+  assert(levels != NULL);
+  assert(level != NULL);
+
+  // base nodes are level 0
+  if (count == 0) {
+    *level = 0;
+    return 0;
+  }
+
+  // otherwise we are one deeper than our deepest fanin
+  uint32_t l = 0;
+  for (size_t i = 0; i < count; i++) {
+    assert(is_known(levels[fanins[i]]));
+    if (levels[fanins[i]] > l)
+      l = levels[fanins[i]];
+  }
+
+  if (l >= LEVEL_MAX)
+    return EOVERFLOW;
+
+  *level = l + 1;
+  return 0;
+}
+
+/// a stack of variables whose levels are being computed
+typedef struct {
+  uint64_t *items;
+  size_t size;
+  size_t capacity;
+} worklist_t;
+
+static int push(worklist_t *s, uint64_t variable_index) {
 
-  // do we need to create the cache first?
-  if (aig->levels == NULL) {
-    aig->levels = calloc(aig->max_index + 1, sizeof(aig->levels[0]));
-    if (aig->levels == NULL)
+  assert(s != NULL);
+
+  if (s->size == s->capacity) {
+    size_t c = s->capacity == 0 ? 64 : s->capacity * 2;
+    if (c < s->capacity || SIZE_MAX / sizeof(s->items[0]) < c)
+      return ENOMEM;
+    uint64_t *i = realloc(s->items, c * sizeof(i[0]));
+    if (i == NULL)
       return ENOMEM;
+    s->items = i;
+    s->capacity = c;
+  }
+
+  s->items[s->size++] = variable_index;
+  return 0;
+}
+
+/** compute the level of a variable and everything it depends on
+ *
+ * This is a depth first search with an explicit stack, so it is not limited
+ * by the depth of the AIG. Each variable is visited twice: once to push its
+ * fanins, and once after they are all known to compute its own level.
+ *
+ * \param aig AIG to read from
+ * \param levels Levels computed so far
+ * \param stack Scratch space for the search
+ * \param root Variable to compute the level of
+ * \returns 0 on success or an errno on failure
+ */
+static int visit(aig_t *aig, uint32_t *levels, worklist_t *stack,
+    uint64_t root) {
+
+  assert(aig != NULL);
+  assert(levels != NULL);
+  assert(stack != NULL);
+  assert(stack->size == 0);
+
+  int rc = push(stack, root);
+  if (rc)
+    return rc;
+
+  while (stack->size > 0) {
+    uint64_t v = stack->items[stack->size - 1];
+
+    // were we pushed more than once and already computed?
+    if (is_known(levels[v])) {
+      --stack->size;
+      continue;
+    }
+
+    uint64_t fanins[2];
+    size_t count;
+    if ((rc = get_fanins(aig, v, fanins, &count)))
+      return rc;
+
+    // are we returning to this variable with all of its fanins known?
+    if (levels[v] == ON_STACK) {
+      if ((rc = combine(levels, fanins, count, &levels[v])))
+        return rc;
+      --stack->size;
+      continue;
+    }
+
+    // otherwise, this is our first visit so queue any fanins yet to be known
+    levels[v] = ON_STACK;
+    for (size_t i = 0; i < count; i++) {
+      if (fanins[i] > aig->max_index)
+        return ERANGE;
+      if (levels[fanins[i]] == ON_STACK)
+        return ELOOP;
+      if (levels[fanins[i]] == UNVISITED) {
+        if ((rc = push(stack, fanins[i])))
+          return rc;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/** mark every input and latch as a base node
+ *
+ * These precede the AND gates, so where an AND gate redefines a variable that
+ * an input or latch has already defined, the input or latch is the definition
+ * that counts. Marking them upfront stops sweep_ands() levelling the AND gate
+ * instead.
+ *
+ * \param aig AIG to read from
+ * \param levels Levels computed so far
+ * \returns 0 on success or an errno on failure
+ */
+static int mark_bases(aig_t *aig, uint32_t *levels) {
+
+  assert(aig != NULL);
+  assert(levels != NULL);
+
+  int rc = 0;
+
+  for (uint64_t i = 0; i < aig->input_count; i += BLOCK) {
+    uint64_t n = aig->input_count - i < BLOCK ? aig->input_count - i : BLOCK;
+    uint64_t inputs[BLOCK];
+    if ((rc = aig_get_inputs(aig, i, n, inputs)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++)
+      levels[inputs[j] / 2] = 0;
+  }
+
+  for (uint64_t i = 0; i < aig->latch_count; i += BLOCK) {
+    uint64_t n = aig->latch_count - i < BLOCK ? aig->latch_count - i : BLOCK;
+    uint64_t current[BLOCK];
+    if ((rc = aig_get_latches(aig, i, n, current, NULL)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++)
+      levels[current[j] / 2] = 0;
+  }
+
+  return 0;
+}
+
+/** compute the levels of all AND gates, in the order they are stored
+ *
+ * In a binary AIG, and most ASCII AIGs, the fanins of a gate precede it. So
+ * typically each gate’s fanins are already known by the time we reach it, and
+ * this is a single linear sweep. Anything else is handed to visit().
+ *
+ * \param aig AIG to read from
+ * \param levels Levels computed so far
+ * \param stack Scratch space for visit()
+ * \returns 0 on success or an errno on failure
+ */
+static int sweep_ands(aig_t *aig, uint32_t *levels, worklist_t *stack) {
+
+  assert(aig != NULL);
+  assert(levels != NULL);
+
+  int rc = 0;
+
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint64_t lhs[BLOCK];
+    uint64_t rhs0[BLOCK];
+    uint64_t rhs1[BLOCK];
+    if ((rc = aig_get_ands(aig, i, n, lhs, rhs0, rhs1)))
+      return rc;
+
+    for (uint64_t j = 0; j < n; j++) {
+      uint64_t v = lhs[j] / 2;
+      if (is_known(levels[v]))
+        continue;
+
+      uint64_t fanins[] = { rhs0[j] / 2, rhs1[j] / 2 };
+      if (is_known(levels[fanins[0]]) && is_known(levels[fanins[1]])) {
+        if ((rc = combine(levels, fanins, 2, &levels[v])))
+          return rc;
+      } else {
+        if ((rc = visit(aig, levels, stack, v)))
+          return rc;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/// minimum number of variables in a wave worth processing in parallel
+enum { MIN_PARALLEL_WAVE = 1 << 14 };
+
+/// minimum number of AND gates worth levelizing in parallel, below which
+/// building the fanout index costs more than the sequential sweep
+enum { MIN_PARALLEL_ANDS = MIN_PARALLEL_WAVE * 8 };
+
+/// number of variables in a wave each parallel task processes
+enum { WAVE_TASK_SIZE = 1 << 12 };
+
+/// state shared between threads levelizing in waves
+typedef struct {
+  aig_t *aig;
+
+  /// levels of every variable, as a running maximum for those yet to be final
+  uint32_t *levels;
+
+  /// number of fanin edges yet to be processed for each AND gate, by position
+  /// counting latches then AND gates
+  uint8_t *pending;
+
+  /// variables in the order their levels became final
+  uint64_t *order;
+
+  /// range of the current wave within order
+  size_t begin;
+  size_t end;
+
+  /// next free slot in order, where the following wave is appended
+  size_t tail;
+} waves_t;
+
+/** finalise a variable’s level and propagate it to its fanouts
+ *
+ * \param ws Wave state
+ * \param v Variable whose level is final
+ * \returns 0 on success or an errno on failure
+ */
+static int propagate(waves_t *ws, uint64_t v) {
+
+  assert(ws != NULL);
+
+  const aig_t *aig = ws->aig;
+
+  uint32_t l = ws->levels[v];
+  if (l >= LEVEL_MAX)
+    return EOVERFLOW;
+
+  for (uint64_t i = fanout_offset(aig, v); i < fanout_offset(aig, v + 1); i++) {
+    uint64_t position = fanout_position(fanout_edge(aig, i));
+
+    // latches are base nodes, so feeding one does not affect its level
+    if (position < aig->latch_count)
+      continue;
+    uint64_t w = get_and_lhs(aig, position - aig->latch_count) / 2;
+
+    // raise the fanout’s level to at least one more than ours
+    uint32_t current = __atomic_load_n(&ws->levels[w], __ATOMIC_RELAXED);
+    while (current < l + 1
+        && !__atomic_compare_exchange_n(&ws->levels[w], &current, l + 1, true,
+          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    // if this was the fanout’s last fanin, its level is now final so it joins
+    // the next wave
+    if (__atomic_sub_fetch(&ws->pending[position], 1, __ATOMIC_ACQ_REL) == 0) {
+      size_t slot = __atomic_fetch_add(&ws->tail, 1, __ATOMIC_RELAXED);
+      ws->order[slot] = w;
+    }
   }
 
-  aig->levels[index] = level;
+  return 0;
+}
+
+/** process a portion of the current wave
+ *
+ * \param arg Wave state
+ * \param task Index of the portion to process
+ * \returns 0 on success or an errno on failure
+ */
+static int propagate_task(void *arg, size_t task) {
+
+  waves_t *ws = arg;
+
+  size_t first = ws->begin + task * WAVE_TASK_SIZE;
+  size_t last = ws->end - first < WAVE_TASK_SIZE ? ws->end
+                                                 : first + WAVE_TASK_SIZE;
+
+  for (size_t i = first; i < last; i++) {
+    int rc = propagate(ws, ws->order[i]);
+    if (rc)
+      return rc;
+  }
+
+  return 0;
+}
+
+/** compute the level of every variable, in waves processed in parallel
+ *
+ * This is Kahn’s algorithm over the fanout index: every variable with no
+ * fanins forms the first wave, and each subsequent wave is formed of the
+ * variables whose fanins all lay in prior waves. A variable’s wave is its
+ * level. Waves large enough to be worthwhile are spread across threads.
+ *
+ * The fanout index is only needed while this runs, so if it was not already
+ * built it is released again afterwards.
+ *
+ * \param aig AIG to read from
+ * \param levels [out] Level of every variable on success
+ * \returns 0 on success or an errno on failure
+ */
+static int levelize_parallel(aig_t *aig, uint32_t *levels) {
+
+  assert(aig != NULL);
+  assert(levels != NULL);
+
+  size_t size = (size_t)aig->max_index + 1;
+  uint64_t nodes = aig->latch_count + aig->and_count;
+
+  if (nodes > SIZE_MAX || size > SIZE_MAX / sizeof(uint64_t))
+    return ENOMEM;
+
+  bool built = fanout_is_built(aig);
+  int rc = fanout_build(aig);
+  if (rc)
+    return rc;
+
+  waves_t ws = { .aig = aig, .levels = levels };
+  ws.pending = malloc(nodes == 0 ? 1 : (size_t)nodes);
+  ws.order = malloc(size * sizeof(ws.order[0]));
+
+  // what kind of node, if any, defines each variable
+  enum { UNDEFINED, BASE, GATE };
+  uint8_t *defined = calloc(size, sizeof(defined[0]));
+  if (ws.pending == NULL || ws.order == NULL || defined == NULL) {
+    rc = ENOMEM;
+    goto done;
+  }
+
+  // if a variable is defined more than once, its level depends on which
+  // definition is found first, so leave it to the sequential algorithm
+  for (uint64_t i = 0; i < aig->input_count; i++) {
+    uint64_t v = get_input(aig, i) / 2;
+    if (defined[v] != UNDEFINED) {
+      rc = ENOTSUP;
+      goto done;
+    }
+    defined[v] = BASE;
+  }
+
+  // every variable starts at level 0, and AND gates wait on their fanins
+  for (size_t i = 0; i < size; i++)
+    levels[i] = 0;
+  for (uint64_t i = 0; i < nodes; i++) {
+    bool latch = i < aig->latch_count;
+    uint64_t v = latch ? get_latch_current(aig, i) / 2
+                       : get_and_lhs(aig, i - aig->latch_count) / 2;
+    if (defined[v] != UNDEFINED) {
+      rc = ENOTSUP;
+      goto done;
+    }
+    defined[v] = latch ? BASE : GATE;
+    ws.pending[i] = latch ? 0 : 2;
+  }
+
+  // the first wave is every variable that waits on nothing
+  for (size_t v = 0; v < size; v++) {
+    if (defined[v] != GATE)
+      ws.order[ws.tail++] = v;
+  }
+
+  while (ws.begin < ws.tail) {
+    ws.end = ws.tail;
+
+    size_t count = ws.end - ws.begin;
+    if (count >= MIN_PARALLEL_WAVE) {
+      size_t tasks = count / WAVE_TASK_SIZE + (count % WAVE_TASK_SIZE != 0);
+      if ((rc = parallel_for(aig->threads, tasks, propagate_task, &ws)))
+        goto done;
+    } else {
+      for (size_t i = ws.begin; i < ws.end; i++) {
+        if ((rc = propagate(&ws, ws.order[i])))
+          goto done;
+      }
+    }
+
+    ws.begin = ws.end;
+  }
+
+  // anything that never became final is waiting on itself
+  if (ws.tail < size)
+    rc = ELOOP;
+
+done:
+  free(defined);
+  free(ws.order);
+  free(ws.pending);
+  if (!built)
+    fanout_discard(aig);
+
+  return rc;
+}
+
+int levelize(aig_t *aig) {
+
+  assert(aig != NULL);
+
+  if (aig->levels != NULL)
+    return 0;
+
+  if (aig->max_index >= SIZE_MAX / sizeof(aig->levels[0]))
+    return ENOMEM;
+
+  size_t size = (size_t)aig->max_index + 1;
+  uint32_t *levels = malloc(size * sizeof(levels[0]));
+  if (levels == NULL)
+    return ENOMEM;
+
+  // if we have threads to spare and enough gates to share between them, try to
+  // do this in parallel
+  if (aig->threads > 1 && aig->and_count >= MIN_PARALLEL_ANDS) {
+    int rc = levelize_parallel(aig, levels);
+    if (rc == 0) {
+      aig->levels = levels;
+      return 0;
+    }
+    if (rc != ENOTSUP) {
+      free(levels);
+      return rc;
+    }
+  }
+
+  for (size_t i = 0; i < size; i++)
+    levels[i] = UNVISITED;
+
+  worklist_t stack = { 0 };
+  int rc = mark_bases(aig, levels);
+  if (rc == 0)
+    rc = sweep_ands(aig, levels, &stack);
+
+  // pick up anything the sweep did not reach, like the constant and undefined
+  // variables
+  for (uint64_t v = 0; rc == 0 && v < size; v++) {
+    if (!is_known(levels[v]))
+      rc = visit(aig, levels, &stack, v);
+  }
+
+  free(stack.items);
+
+  if (rc) {
+    free(levels);
+    return rc;
+  }
+
+  aig->levels = levels;
 
   return 0;
 }
@@ -37,112 +544,185 @@ int aig_node_level(aig_t *aig, const struct aig_node *node, size_t *level) {
   if (level == NULL)
     return EINVAL;
 
+  uint64_t v = 0;
   switch (node->type) {
 
-    // constants and inputs are both base nodes
+    // constants, inputs, and latches are all base nodes
     case AIG_CONSTANT:
     case AIG_INPUT:
+    case AIG_LATCH:
       *level = 0;
       return 0;
 
-    case AIG_LATCH: {
+    // an output has the level of the node it is wired up to
+    case AIG_OUTPUT:
+      v = node->output.variable_index;
+      break;
 
-      // does this latch have an invalid index (inconsistent AIG)?
-      if (node->latch.current > aig->max_index)
-        return ERANGE;
+    case AIG_AND_GATE:
+      v = node->and_gate.lhs;
+      break;
+  }
 
-      // if we have the level of this node cached, retrieve from there
-      if (aig->levels != NULL && aig->levels[node->latch.current] != 0) {
-        *level = aig->levels[node->latch.current];
-        return 0;
-      }
+  // does this node have an invalid index (inconsistent AIG)?
+  if (v > aig->max_index)
+    return ERANGE;
 
-      // find the node for its next state
-      struct aig_node n;
-      int rc = aig_get_node(aig, node->latch.next, &n);
-      if (rc)
-        return rc;
+  int rc = levelize(aig);
+  if (rc)
+    return rc;
 
-      // find the level of that node
-      size_t l;
-      if ((rc = aig_node_level(aig, &n, &l)))
-        return rc;
+  *level = aig->levels[v];
+  return 0;
+}
+
+/** find the level of each of a range of AND gates
+ *
+ * This is computed from each gate’s own operands. It only differs from the
+ * level of the gate’s variable when an earlier node also defines that
+ * variable, and ensures every gate still lies above its operands.
+ *
+ * \param aig AIG to read from, with levels already computed
+ * \param first Index of the first AND gate
+ * \param count Number of AND gates, at most BLOCK
+ * \param levels [out] Level of each AND gate on success
+ * \returns 0 on success or an errno on failure
+ */
+static int get_and_levels(aig_t *aig, uint64_t first, uint64_t count,
+    uint32_t *levels) {
 
-      // then we are one deeper
-      *level = l + 1;
+  assert(aig != NULL);
+  assert(aig->levels != NULL);
+  assert(count <= BLOCK);
+
+  uint64_t rhs0[BLOCK];
+  uint64_t rhs1[BLOCK];
+  int rc = aig_get_ands(aig, first, count, NULL, rhs0, rhs1);
+  if (rc)
+    return rc;
+
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t fanins[] = { rhs0[i] / 2, rhs1[i] / 2 };
+    if ((rc = combine(aig->levels, fanins, 2, &levels[i])))
+      return rc;
+  }
+
+  return 0;
+}
 
-      // cache this for future calls; ignore failure as it is tolerable
-      (void)cache_level(aig, node->latch.current, *level);
+int bucket_levels(aig_t *aig) {
 
-      return 0;
+  assert(aig != NULL);
+
+  if (aig->level_offsets != NULL)
+    return 0;
+
+  int rc = levelize(aig);
+  if (rc)
+    return rc;
+
+  // find the deepest AND gate
+  uint32_t deepest = 0;
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint32_t l[BLOCK];
+    if ((rc = get_and_levels(aig, i, n, l)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      if (l[j] > deepest)
+        deepest = l[j];
     }
+  }
 
-    case AIG_OUTPUT: {
+  if (aig->and_count > SIZE_MAX / sizeof(uint64_t))
+    return ENOMEM;
 
-      // does this output have an invalid index?
-      if (node->output.variable_index > aig->max_index)
-        return ERANGE;
+  uint64_t *offsets = calloc((size_t)deepest + 2, sizeof(offsets[0]));
+  uint64_t *gates = malloc((aig->and_count == 0 ? 1 : (size_t)aig->and_count)
+                           * sizeof(gates[0]));
+  if (offsets == NULL || gates == NULL) {
+    rc = ENOMEM;
+    goto fail;
+  }
 
-      // if we have the level of this node cached, retrieve from there
-      if (aig->levels != NULL && aig->levels[node->output.variable_index] != 0) {
-        *level = aig->levels[node->output.variable_index];
-        return 0;
-      }
+  // count the gates at each level
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint32_t l[BLOCK];
+    if ((rc = get_and_levels(aig, i, n, l)))
+      goto fail;
+    for (uint64_t j = 0; j < n; j++)
+      ++offsets[l[j] + 1];
+  }
 
-      // if the user gave us an output, look up the input, latch, or AND gate it
-      // is actually wired up to
-      struct aig_node n;
-      int rc = aig_get_node(aig, node->output.variable_index, &n);
-      if (rc)
-        return rc;
+  // accumulate these into the start of each level’s bucket
+  for (size_t l = 0; l <= deepest; l++)
+    offsets[l + 1] += offsets[l];
+
+  // place each gate into its bucket, using the starts as cursors
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint32_t l[BLOCK];
+    if ((rc = get_and_levels(aig, i, n, l)))
+      goto fail;
+    for (uint64_t j = 0; j < n; j++)
+      gates[offsets[l[j]]++] = i + j;
+  }
 
-      // then delegate to finding the level of that
-      return aig_node_level(aig, &n, level);
-    }
+  // shift the cursors back into place as starts
+  for (size_t l = (size_t)deepest + 1; l > 0; l--)
+    offsets[l] = offsets[l - 1];
+  offsets[0] = 0;
 
-    case AIG_AND_GATE: {
+  aig->level_offsets = offsets;
+  aig->level_gates = gates;
+  aig->level_count = (size_t)deepest + 1;
 
-      // does this AND gate have an invalid index?
-      if (node->and_gate.lhs > aig->max_index)
-        return ERANGE;
+  return 0;
 
-      // if we have the level of this node cached, retrieve from there
-      if (aig->levels != NULL && aig->levels[node->input.variable_index] != 0) {
-        *level = aig->levels[node->input.variable_index];
-        return 0;
-      }
+fail:
+  free(gates);
+  free(offsets);
+  return rc;
+}
 
-      // find the node for its first RHS term
-      struct aig_node rhs0;
-      int rc = aig_get_node(aig, node->and_gate.rhs[0], &rhs0);
-      if (rc)
-        return rc;
+int aig_level_count(aig_t *aig, size_t *count) {
 
-      // find the level of this node
-      size_t l_rhs0;
-      if ((rc = aig_node_level(aig, &rhs0, &l_rhs0)))
-        return rc;
+  if (aig == NULL)
+    return EINVAL;
 
-      // now repeat the process for the second RHS term
-      struct aig_node rhs1;
-      if ((rc = aig_get_node(aig, node->and_gate.rhs[1], &rhs1)))
-        return rc;
+  if (count == NULL)
+    return EINVAL;
 
-      size_t l_rhs1;
-      if ((rc = aig_node_level(aig, &rhs1, &l_rhs1)))
-        return rc;
+  int rc = bucket_levels(aig);
+  if (rc)
+    return rc;
 
-      // our level is one more than the greatest of these
-      *level = max(l_rhs0, l_rhs1) + 1;
+  *count = aig->level_count;
+  return 0;
+}
 
-      // cache this for future calls; ignore failure as it is tolerable
-      (void)cache_level(aig, node->and_gate.lhs, *level);
+int aig_level_gates(aig_t *aig, size_t level, const uint64_t **gates,
+    size_t *count) {
 
-      return 0;
-    }
-  }
+  if (aig == NULL)
+    return EINVAL;
+
+  if (gates == NULL)
+    return EINVAL;
 
-  // all cases are handled above
-  assert(!"unreachable");
-  return ENOTRECOVERABLE;
+  if (count == NULL)
+    return EINVAL;
+
+  int rc = bucket_levels(aig);
+  if (rc)
+    return rc;
+
+  if (level >= aig->level_count)
+    return ERANGE;
+
+  uint64_t begin = aig->level_offsets[level];
+  *gates = &aig->level_gates[begin];
+  *count = (size_t)(aig->level_offsets[level + 1] - begin);
+  return 0;
 }
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <stdint.h>
+
+/// largest level that can be stored in aig->levels
+enum { LEVEL_MAX = UINT32_MAX - 2 };
+
+/** compute the level of every variable in an AIG into aig->levels
+ *
+ * Calling this on an AIG whose levels are already computed is a no-op.
+ * Variables that no node defines are given level 0.
+ *
+ * \param aig AIG to operate on
+ * \returns 0 on success, ELOOP if the AIG contains a cycle, or another errno on
+ *   failure
+ */
+__attribute__((visibility("internal")))
+int levelize(aig_t *aig);
+
+/** sort the AND gates of an AIG into buckets by level
+ *
+ * This computes levels with levelize() if they are not already known. The
+ * gates at level l are then aig->level_gates[aig->level_offsets[l]] up to
+ * aig->level_gates[aig->level_offsets[l + 1]], in increasing index order.
+ * Calling this on an AIG whose buckets already exist is a no-op.
+ *
+ * \param aig AIG to operate on
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int bucket_levels(aig_t *aig);
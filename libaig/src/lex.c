@@ -0,0 +1,217 @@
+#include <assert.h>
+#include <ctype.h>
+#include "lex.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// can we treat 8 bytes loaded from memory as a little endian word?
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  #define HAVE_SWAR 1
+#else
+  #define HAVE_SWAR 0
+#endif
+
+/// the longest digit sequence that cannot overflow a uint64_t
+enum { MAX_DIGITS = 19 };
+
+static bool is_space(char c) {
+  // check the common separators before deferring to the full classification
+  return c == ' ' || c == '\n' || isspace(c);
+}
+
+static bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+#if HAVE_SWAR
+
+/// repeat a byte into every byte of a word
+#define BYTES(b) (UINT64_C(0x0101010101010101) * (b))
+
+/** count the leading digits in 8 bytes
+ *
+ * \param word 8 bytes of data, the first in the least significant byte
+ * \returns The number of digits before the first non-digit
+ */
+static size_t digit_prefix(uint64_t word) {
+
+  // the high nibble of a digit is 3, and the high nibble after adding 6 to a
+  // digit is still 3; any other byte fails at least one of these, leaving a
+  // non-zero high nibble in the corresponding byte of nondigit
+  //
+  // A carry out of the addition only happens from a byte ≥ 0xfa, which is a
+  // non-digit. So it can only corrupt bytes after the first non-digit.
+  uint64_t nondigit = ((word & BYTES(0xf0)) ^ BYTES(0x30))
+                    | (((word + BYTES(0x06)) & BYTES(0xf0)) ^ BYTES(0x30));
+
+  // fold each high nibble down into its byte’s top bit
+  uint64_t mask = (nondigit | nondigit << 1 | nondigit << 2 | nondigit << 3)
+                & BYTES(0x80);
+
+  if (mask == 0)
+    return 8;
+
+  return (size_t)__builtin_ctzll(mask) / 8;
+}
+
+/** convert up to 8 digits to their numeric value
+ *
+ * \param word 8 bytes of data, the first in the least significant byte
+ * \param digits Number of leading digits in word, 1 – 8
+ * \returns The value of the digits
+ */
+static uint64_t digits_value(uint64_t word, size_t digits) {
+
+  assert(digits > 0 && digits <= 8);
+
+  // convert ASCII to digit values; any borrow out of a non-digit byte only
+  // propagates towards bytes after it, which are discarded next
+  word -= BYTES('0');
+
+  // shift the digits to the top of the word, so the vacated bytes act as
+  // leading zeros
+  word <<= 8 * (8 - digits);
+
+  // combine pairs of digits, then pairs of those, then pairs of those
+  word = word * 10 + (word >> 8);
+  word = (((word & UINT64_C(0x000000ff000000ff))
+              * (100 + (UINT64_C(1000000) << 32)))
+        + (((word >> 16) & UINT64_C(0x000000ff000000ff))
+              * (1 + (UINT64_C(10000) << 32)))) >> 32;
+
+  return word;
+}
+
+#endif
+
+/** lex a decimal number
+ *
+ * \param cursor [in,out] Position to lex from, advanced past the number
+ * \param end End of the available data
+ * \param out [out] The parsed number on success
+ * \returns True on success
+ */
+static bool lex_num(const char **cursor, const char *end, uint64_t *out) {
+
+  assert(cursor != NULL);
+  assert(out != NULL);
+
+  const char *p = *cursor;
+  uint64_t v = 0;
+  size_t digits = 0;
+
+#if HAVE_SWAR
+  // consume 8 bytes at a time while we have them
+  while (end - p >= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+
+    size_t n = digit_prefix(word);
+    if (n == 0)
+      break;
+
+    // if we exceed the number of digits that can never overflow, leave it to
+    // the general parser to handle and diagnose
+    if (digits + n > MAX_DIGITS)
+      return false;
+
+    static const uint64_t POW10[] = { 1, 10, 100, 1000, 10000, 100000,
+      1000000, 10000000, 100000000 };
+    v = v * POW10[n] + digits_value(word, n);
+    digits += n;
+    p += n;
+
+    // if we found the end of the digits, we are done
+    if (n < 8)
+      break;
+  }
+#endif
+
+  // handle any remaining digits a byte at a time
+  for (; p < end && is_digit(*p); ++p) {
+    if (digits == MAX_DIGITS)
+      return false;
+    v = v * 10 + (uint64_t)(*p - '0');
+    ++digits;
+  }
+
+  if (digits == 0)
+    return false;
+
+  *cursor = p;
+  *out = v;
+  return true;
+}
+
+/** lex a separator between numbers
+ *
+ * \param cursor [in,out] Position to lex from, advanced past the separator
+ * \param end End of the available data
+ * \param strict Whether to demand exact white space conformance
+ * \param expected In strict mode, the sole character to accept
+ * \returns True on success
+ */
+static bool lex_space(const char **cursor, const char *end, bool strict,
+    char expected) {
+
+  assert(cursor != NULL);
+
+  const char *p = *cursor;
+
+  if (p == end)
+    return false;
+
+  if (strict) {
+    if (*p != expected)
+      return false;
+    *cursor = p + 1;
+    return true;
+  }
+
+  if (!is_space(*p))
+    return false;
+
+  for (++p; p < end && is_space(*p); ++p);
+
+  *cursor = p;
+  return true;
+}
+
+bool lex_and(const char **cursor, const char *end, bool strict, uint64_t *lhs,
+    uint64_t *rhs0, uint64_t *rhs1) {
+
+  assert(cursor != NULL);
+  assert(*cursor != NULL);
+  assert(end != NULL);
+  assert(lhs != NULL);
+  assert(rhs0 != NULL);
+  assert(rhs1 != NULL);
+
+  const char *p = *cursor;
+
+  // in non-strict mode, ignore leading white space
+  if (!strict)
+    for (; p < end && is_space(*p); ++p);
+
+  uint64_t l, r0, r1;
+  if (!lex_num(&p, end, &l))
+    return false;
+  if (!lex_space(&p, end, strict, ' '))
+    return false;
+  if (!lex_num(&p, end, &r0))
+    return false;
+  if (!lex_space(&p, end, strict, ' '))
+    return false;
+  if (!lex_num(&p, end, &r1))
+    return false;
+  if (!lex_space(&p, end, strict, '\n'))
+    return false;
+
+  *cursor = p;
+  *lhs = l;
+  *rhs0 = r0;
+  *rhs1 = r1;
+  return true;
+}
@@ -0,0 +1,34 @@
+// fast paths for tokenising in-memory ASCII AIGER data
+//
+// The parser in parse.c works a byte at a time against any kind of source.
+// When the source is in memory, the hot lines of an AIG can instead be lexed
+// directly from the underlying bytes, several at a time. The functions below
+// only accept the common well-formed shapes of these lines, and leave anything
+// else to the general parser so that its semantics (error codes, white space
+// handling) are preserved exactly.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** lex an AND gate line of an ASCII AIG
+ *
+ * In strict mode, this accepts "lhs rhs0 rhs1\n". In non-strict mode, it
+ * accepts the same with any leading white space, any non-empty white space
+ * separators, and any non-empty run of trailing white space, all of which are
+ * consumed.
+ *
+ * \param cursor [in,out] Start of the line to lex, advanced past the line on
+ *   success and unmodified on failure
+ * \param end End of the available data
+ * \param strict Whether to demand exact white space conformance
+ * \param lhs [out] The parsed LHS on success
+ * \param rhs0 [out] The parsed first operand on success
+ * \param rhs1 [out] The parsed second operand on success
+ * \returns True if the line was lexed, false if the caller should fall back to
+ *   the general parser
+ */
+__attribute__((visibility("internal")))
+bool lex_and(const char **cursor, const char *end, bool strict, uint64_t *lhs,
+  uint64_t *rhs0, uint64_t *rhs1);
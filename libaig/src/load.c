@@ -1,17 +1,49 @@
 #include <aig/aig.h>
 #include "aig_t.h"
 #include <assert.h>
+#include "bitbuffer.h"
 #include <errno.h>
 #include <limits.h>
+#include "node_map.h"
 #include "parse.h"
+#include "source.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/** pre-size a bit buffer for the number of entries the header claims
+ *
+ * The header counts are untrusted, so the reservation is capped at the number
+ * of bytes left in the source. Every entry consumes at least one byte, so a
+ * file claiming more than this will fail to parse anyway, and is left to do so
+ * instead of triggering a huge allocation. If the remaining size is unknown,
+ * nothing is reserved and the buffer grows as entries are appended.
+ *
+ * \param aig AIG being loaded
+ * \param bb Bit buffer to reserve space in
+ * \param count Number of entries the header claims
+ * \returns 0 on success or an errno on failure
+ */
+static int reserve(aig_t *aig, bitbuffer_t *bb, uint64_t count) {
+
+  assert(aig != NULL);
+  assert(bb != NULL);
+
+  size_t remaining;
+  if (!source_remaining(&aig->source, &remaining))
+    return 0;
+
+  if (count > remaining)
+    count = remaining;
+
+  return bb_reserve(bb, count, bb_limit(aig));
+}
+
 static int load(aig_t *aig) {
 
   assert(aig != NULL);
-  assert(aig->source != NULL);
+  assert(source_is_open(&aig->source));
 
   int rc = 0;
 
@@ -32,40 +64,50 @@ static int load(aig_t *aig) {
   if (!aig->eager)
     return rc;
 
+  // we are about to fill the arrays whose sizes the header tells us, so
+  // allocate them once upfront instead of growing them as we go
+  if ((rc = reserve(aig, &aig->latch_next, aig->latch_count)))
+    return rc;
+  if ((rc = reserve(aig, &aig->outputs, aig->output_count)))
+    return rc;
+  if (!aig->compress) {
+    uint64_t rhs_count = aig->and_count > UINT64_MAX / 2 ? UINT64_MAX
+                                                        : aig->and_count * 2;
+    if ((rc = reserve(aig, &aig->and_rhs, rhs_count)))
+      return rc;
+  }
+
   // parse the other sections in the file
   if ((rc = parse_all(aig)))
     return rc;
 
-  return rc;
-}
-
-int aig_load(aig_t **aig, const char *filename, struct aig_options options) {
-
-  if (aig == NULL)
-    return EINVAL;
-
-  if (filename == NULL)
-    return EINVAL;
-
-  FILE *f = fopen(filename, "r");
-  if (f == NULL)
-    return errno;
+  // the nodes of an ASCII AIG may be out of order, so construct the map for
+  // finding them now while we are doing all the work upfront
+  if (!aig->binary) {
+    if ((rc = node_map_build(aig)))
+      return rc;
+  }
 
-  int rc = aig_loadf(aig, f, options);
-
-  if (rc)
-    fclose(f);
+  // we have everything we need from the source, so release it early
+  source_close(&aig->source);
 
   return rc;
 }
 
-int aig_loadf(aig_t **aig, FILE *f, struct aig_options options) {
-
-  if (aig == NULL)
-    return EINVAL;
+/** set up a new AIG to be parsed from the given source
+ *
+ * On success, the AIG takes ownership of the source. On failure, the source is
+ * left for the caller to clean up.
+ *
+ * \param aig [out] Handle to the initialised data structure
+ * \param source Source to read from
+ * \param options Configuration for parsing
+ * \returns 0 on success or an errno on failure
+ */
+static int load_from(aig_t **aig, source_t source, struct aig_options options) {
 
-  if (f == NULL)
-    return EINVAL;
+  assert(aig != NULL);
+  assert(source_is_open(&source));
 
   int rc = 0;
 
@@ -73,9 +115,11 @@ int aig_loadf(aig_t **aig, FILE *f, struct aig_options options) {
   if ((rc = aig_new(&a, options)))
     goto done;
 
-  a->source = f;
+  a->source = source;
   a->strict = options.strict;
   a->eager = options.eager;
+  a->compress = options.compress;
+  a->threads = options.threads;
 
   if ((rc = load(a)))
     goto done;
@@ -84,25 +128,38 @@ done:
   if (rc == 0) {
     *aig = a;
   } else {
-    // if we got as far as adding the file handle the data structure, remove it
+    // if we got as far as adding the source to the data structure, remove it
     // so it is not closed by aig_free()
-    if (a != NULL && a->source != NULL)
-      a->source = NULL;
+    if (a != NULL)
+      memset(&a->source, 0, sizeof(a->source));
     aig_free(&a);
   }
 
   return rc;
 }
 
-int aig_parse(aig_t **aig, const char *content, struct aig_options options) {
+int aig_load(aig_t **aig, const char *filename, struct aig_options options) {
 
   if (aig == NULL)
     return EINVAL;
 
-  if (content == NULL)
+  if (filename == NULL)
     return EINVAL;
 
-  FILE *f = fmemopen((void*)content, strlen(content), "r");
+  // if requested, read directly from the file’s contents mapped into memory
+  if (options.memory_map) {
+    source_t s;
+    int rc = source_map(&s, filename);
+    if (rc)
+      return rc;
+
+    if ((rc = load_from(aig, s, options)))
+      source_close(&s);
+
+    return rc;
+  }
+
+  FILE *f = fopen(filename, "r");
   if (f == NULL)
     return errno;
 
@@ -113,3 +170,41 @@ int aig_parse(aig_t **aig, const char *content, struct aig_options options) {
 
   return rc;
 }
+
+int aig_loadf(aig_t **aig, FILE *f, struct aig_options options) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (f == NULL)
+    return EINVAL;
+
+  return load_from(aig, (source_t){ .file = f }, options);
+}
+
+int aig_parse(aig_t **aig, const char *content, struct aig_options options) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (content == NULL)
+    return EINVAL;
+
+  return aig_parse_buffer(aig, content, strlen(content), options);
+}
+
+int aig_parse_buffer(aig_t **aig, const void *buffer, size_t length,
+    struct aig_options options) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (buffer == NULL)
+    return EINVAL;
+
+  // read directly from the caller’s buffer, which we do not own so will never
+  // release
+  source_t s = { .base = buffer, .size = length };
+
+  return load_from(aig, s, options);
+}
@@ -2,9 +2,12 @@
 #include "aig_t.h"
 #include <assert.h>
 #include "bitbuffer.h"
+#include "deltabuffer.h"
 #include <errno.h>
 #include "infer.h"
+#include "node_map.h"
 #include "parse.h"
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -88,7 +91,7 @@ int aig_get_latch_no_symbol(aig_t *aig, uint64_t index,
 
   memset(result, 0, sizeof(*result));
   result->type = AIG_LATCH;
-  result->latch.current = index + 1 + aig->input_count;
+  result->latch.current = get_latch_current(aig, index) / 2;
   result->latch.next = next / 2;
   result->latch.next_negated = next % 2;
 
@@ -195,29 +198,23 @@ int aig_get_and(aig_t *aig, uint64_t index, struct aig_node *result) {
   if (rc)
     return rc;
 
-  // retrieve the AND gate’s LHS
-  uint64_t lhs;
-  if (aig->binary) {
-    // for a binary AIG, we can infer the LHS because the AND gates are ordered
-    // and consecutive
-    lhs = get_inferred_and_lhs(aig, index);
-  } else {
-    // for an ASCII AIG, the LHS is either inferable, in which case we have no
-    // LHS data, or it is stored in a bit buffer
-    if (bb_is_empty(&aig->and_lhs)) { // inferable
-      lhs = get_inferred_and_lhs(aig, index);
-    } else { // stored
-      if ((rc = bb_get(&aig->and_lhs, index, bb_limit(aig), &lhs)))
-        return rc;
-    }
-  }
+  // retrieve the AND gate’s LHS, which is either inferable or recorded as an
+  // exception (only possible for an ASCII AIG)
+  uint64_t lhs = get_and_lhs(aig, index);
 
   // retrieve the AND gate’s RHS
   uint64_t rhs0, rhs1;
-  if ((rc = bb_get(&aig->and_rhs, index * 2, bb_limit(aig), &rhs0)))
-    return rc;
-  if ((rc = bb_get(&aig->and_rhs, index * 2 + 1, bb_limit(aig), &rhs1)))
-    return rc;
+  if (aig->compress) {
+    if ((rc = db_get(&aig->and_rhs_deltas, index * 2, lhs, &rhs0)))
+      return rc;
+    if ((rc = db_get(&aig->and_rhs_deltas, index * 2 + 1, lhs, &rhs1)))
+      return rc;
+  } else {
+    if ((rc = bb_get(&aig->and_rhs, index * 2, bb_limit(aig), &rhs0)))
+      return rc;
+    if ((rc = bb_get(&aig->and_rhs, index * 2 + 1, bb_limit(aig), &rhs1)))
+      return rc;
+  }
 
   memset(result, 0, sizeof(*result));
   result->type = AIG_AND_GATE;
@@ -230,13 +227,33 @@ int aig_get_and(aig_t *aig, uint64_t index, struct aig_node *result) {
   return 0;
 }
 
-int aig_get_node(aig_t *aig, uint64_t variable_index, struct aig_node *result) {
+/// retrieve an input, optionally with its symbol
+static int get_input_node(aig_t *aig, uint64_t index, bool symbol,
+    struct aig_node *result) {
+  return symbol ? aig_get_input(aig, index, result)
+                : aig_get_input_no_symbol(aig, index, result);
+}
 
-  if (aig == NULL)
-    return EINVAL;
+/// retrieve a latch, optionally with its symbol
+static int get_latch_node(aig_t *aig, uint64_t index, bool symbol,
+    struct aig_node *result) {
+  return symbol ? aig_get_latch(aig, index, result)
+                : aig_get_latch_no_symbol(aig, index, result);
+}
 
-  if (result == NULL)
-    return EINVAL;
+/** lookup a node by variable index
+ *
+ * \param aig AIG data structure to search
+ * \param variable_index Index of the sought node
+ * \param symbol Whether to parse as far as the node’s symbol, if it has one
+ * \param result [out] The located node if successful
+ * \returns 0 on success or an errno on failure
+ */
+static int get_node(aig_t *aig, uint64_t variable_index, bool symbol,
+    struct aig_node *result) {
+
+  assert(aig != NULL);
+  assert(result != NULL);
 
   // index 0 is the constant FALSE
   if (variable_index == 0) {
@@ -252,54 +269,59 @@ int aig_get_node(aig_t *aig, uint64_t variable_index, struct aig_node *result) {
     uint64_t i = variable_index - 1;
 
     if (i < aig->input_count)
-      return aig_get_input(aig, i, result);
+      return get_input_node(aig, i, symbol, result);
     i -= aig->input_count;
 
     if (i < aig->latch_count)
-      return aig_get_latch(aig, i, result);
+      return get_latch_node(aig, i, symbol, result);
     i -= aig->latch_count;
 
     if (i < aig->and_count)
       return aig_get_and(aig, i, result);
 
   } else {
-    // indices can appear out of order in the ASCII format, so we need to step
-    // through the nodes until we find it
-
-    int rc = 0;
-    struct aig_node n;
-
-    for (uint64_t i = 0; i < aig->input_count; i++) {
-      if ((rc = aig_get_input(aig, i, &n)))
-        return rc;
-      assert(n.type == AIG_INPUT);
-      if (n.input.variable_index == variable_index) {
-        *result = n;
-        return 0;
-      }
-    }
-
-    for (uint64_t i = 0; i < aig->latch_count; i++) {
-      if ((rc = aig_get_latch(aig, i, &n)))
-        return rc;
-      assert(n.type == AIG_LATCH);
-      if (n.latch.current == variable_index) {
-        *result = n;
-        return 0;
-      }
-    }
-
-    for (uint64_t i = 0; i < aig->and_count; i++) {
-      if ((rc = aig_get_and(aig, i, &n)))
-        return rc;
-      assert(n.type == AIG_AND_GATE);
-      if (n.and_gate.lhs == variable_index) {
-        *result = n;
-        return 0;
-      }
+    // indices can appear out of order in the ASCII format, so we need to
+    // lookup where this one is defined
+
+    enum aig_node_type type;
+    uint64_t index;
+    int rc = node_map_find(aig, variable_index, &type, &index);
+    if (rc)
+      return rc;
+
+    switch (type) {
+      case AIG_INPUT:    return get_input_node(aig, index, symbol, result);
+      case AIG_LATCH:    return get_latch_node(aig, index, symbol, result);
+      case AIG_AND_GATE: return aig_get_and(aig, index, result);
+      default:
+        assert(!"unreachable");
+        return ENOTRECOVERABLE;
     }
   }
 
   // if we reached here, the caller gave us an invalid variable index
   return ERANGE;
 }
+
+int aig_get_node(aig_t *aig, uint64_t variable_index, struct aig_node *result) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (result == NULL)
+    return EINVAL;
+
+  return get_node(aig, variable_index, true, result);
+}
+
+int aig_get_node_no_symbol(aig_t *aig, uint64_t variable_index,
+    struct aig_node *result) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (result == NULL)
+    return EINVAL;
+
+  return get_node(aig, variable_index, false, result);
+}
@@ -2,9 +2,11 @@
 #include "aig_t.h"
 #include <assert.h>
 #include <errno.h>
+#include "level.h"
 #include "node_iter.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include "topo.h"
 
 // default iterator has_next() behaviour
 static bool has_next(const aig_node_iter_t *it) {
@@ -25,8 +27,14 @@ static bool has_next(const aig_node_iter_t *it) {
   return true;
 }
 
-// default iterator next() behaviour
-static int next(aig_node_iter_t *it, struct aig_node *item) {
+/** retrieve the next node and advance the iterator
+ *
+ * \param it Iterator to operate on
+ * \param symbol Whether to parse as far as the node’s symbol, if it has one
+ * \param item [out] The next node in the iteration on success
+ * \returns 0 on success or an errno on failure
+ */
+static int next_node(aig_node_iter_t *it, bool symbol, struct aig_node *item) {
 
   assert(it != NULL);
   assert(item != NULL);
@@ -39,7 +47,8 @@ static int next(aig_node_iter_t *it, struct aig_node *item) {
 
   // are we currently pointing at an input?
   if (index < it->aig->input_count) {
-    int rc = aig_get_input(it->aig, index, item);
+    int rc = symbol ? aig_get_input(it->aig, index, item)
+                    : aig_get_input_no_symbol(it->aig, index, item);
     ++it->index;
     return rc;
   }
@@ -47,7 +56,8 @@ static int next(aig_node_iter_t *it, struct aig_node *item) {
 
   // are we currently pointing at a latch?
   if (index < it->aig->latch_count) {
-    int rc = aig_get_latch(it->aig, index, item);
+    int rc = symbol ? aig_get_latch(it->aig, index, item)
+                    : aig_get_latch_no_symbol(it->aig, index, item);
     ++it->index;
     return rc;
   }
@@ -55,7 +65,8 @@ static int next(aig_node_iter_t *it, struct aig_node *item) {
 
   // are we currently pointing at an output?
   if (index < it->aig->output_count) {
-    int rc = aig_get_output(it->aig, index, item);
+    int rc = symbol ? aig_get_output(it->aig, index, item)
+                    : aig_get_output_no_symbol(it->aig, index, item);
     ++it->index;
     return rc;
   }
@@ -69,6 +80,16 @@ static int next(aig_node_iter_t *it, struct aig_node *item) {
   return rc;
 }
 
+// default iterator next() behaviour
+static int next(aig_node_iter_t *it, struct aig_node *item) {
+  return next_node(it, true, item);
+}
+
+// next() behaviour of an iterator that does not retrieve symbols
+static int next_no_symbol(aig_node_iter_t *it, struct aig_node *item) {
+  return next_node(it, false, item);
+}
+
 int aig_iter(aig_t *aig, aig_node_iter_t **it) {
 
   if (aig == NULL)
@@ -96,6 +117,128 @@ int aig_iter(aig_t *aig, aig_node_iter_t **it) {
   return 0;
 }
 
+int aig_iter_no_symbol(aig_t *aig, aig_node_iter_t **it) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (it == NULL)
+    return EINVAL;
+
+  aig_node_iter_t *i = NULL;
+  int rc = aig_iter(aig, &i);
+  if (rc)
+    return rc;
+
+  // override the next-finding mechanism with one that skips symbols
+  i->next = next_no_symbol;
+
+  *it = i;
+  return 0;
+}
+
+// has_next() behaviour of iterators over only AND gates
+static bool ands_has_next(const aig_node_iter_t *it) {
+
+  assert(it != NULL);
+
+  if (it->aig == NULL)
+    return false;
+
+  // if the current index is out of range, we are exhausted
+  if (it->index >= it->aig->and_count)
+    return false;
+
+  // otherwise, there is more to consume
+  return true;
+}
+
+// level iterator next() behaviour
+static int level_next(aig_node_iter_t *it, struct aig_node *item) {
+
+  assert(it != NULL);
+  assert(item != NULL);
+  assert(aig_iter_has_next(it));
+
+  if (it->aig == NULL)
+    return EINVAL;
+
+  // look up which AND gate is next in level order
+  uint64_t index = it->aig->level_gates[it->index];
+
+  int rc = aig_get_and(it->aig, index, item);
+  ++it->index;
+  return rc;
+}
+
+int aig_iter_level(aig_t *aig, aig_node_iter_t **it) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (it == NULL)
+    return EINVAL;
+
+  // ensure the AND gates are sorted by level
+  int rc = bucket_levels(aig);
+  if (rc)
+    return rc;
+
+  aig_node_iter_t *i = NULL;
+  if ((rc = aig_iter(aig, &i)))
+    return rc;
+
+  // override the next-finding mechanism with one that follows level order
+  i->has_next = ands_has_next;
+  i->next = level_next;
+
+  *it = i;
+  return 0;
+}
+
+// topological iterator next() behaviour
+static int topo_next(aig_node_iter_t *it, struct aig_node *item) {
+
+  assert(it != NULL);
+  assert(item != NULL);
+  assert(aig_iter_has_next(it));
+
+  if (it->aig == NULL)
+    return EINVAL;
+
+  // look up which AND gate is next in topological order
+  uint64_t index = topo_gate(it->aig, it->index);
+
+  int rc = aig_get_and(it->aig, index, item);
+  ++it->index;
+  return rc;
+}
+
+int aig_iter_topological(aig_t *aig, aig_node_iter_t **it) {
+
+  if (aig == NULL)
+    return EINVAL;
+
+  if (it == NULL)
+    return EINVAL;
+
+  // ensure the AND gates have a topological order
+  int rc = topo_sort(aig);
+  if (rc)
+    return rc;
+
+  aig_node_iter_t *i = NULL;
+  if ((rc = aig_iter(aig, &i)))
+    return rc;
+
+  // override the next-finding mechanism with one that follows this order
+  i->has_next = ands_has_next;
+  i->next = topo_next;
+
+  *it = i;
+  return 0;
+}
+
 bool aig_iter_has_next(const aig_node_iter_t *it) {
 
   if (it == NULL)
@@ -0,0 +1,280 @@
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <assert.h>
+#include <errno.h>
+#include "exceptions.h"
+#include "infer.h"
+#include "node_map.h"
+#include "parse.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/// number of nodes to decode at once
+enum { BLOCK = 256 };
+
+/// a variable defined away from its inferred position
+typedef struct {
+  uint64_t variable_index;
+  uint64_t position;
+} entry_t;
+
+static int cmp_entry(const void *a, const void *b) {
+  const entry_t *x = a;
+  const entry_t *y = b;
+  if (x->variable_index != y->variable_index)
+    return x->variable_index < y->variable_index ? -1 : 1;
+  if (x->position != y->position)
+    return x->position < y->position ? -1 : 1;
+  return 0;
+}
+
+/// total number of nodes that define a variable
+static uint64_t node_count(const aig_t *aig) {
+  assert(aig != NULL);
+  return aig->input_count + aig->latch_count + aig->and_count;
+}
+
+/// number of nodes recorded so far as being away from their inferred position
+static size_t exception_count(const aig_t *aig) {
+  assert(aig != NULL);
+  return aig->inputs.count + aig->latch_current.count + aig->and_lhs.count;
+}
+
+/** find the node at a given position, counting through inputs, latches, and
+ * then AND gates
+ *
+ * \param aig AIG to read from
+ * \param position Position of the node
+ * \param type [out] Type of the node on success
+ * \param index [out] Index of the node within its type on success
+ * \param variable_index [out] Variable index the node defines on success
+ * \returns 0 on success or an errno on failure
+ */
+static int node_at(aig_t *aig, uint64_t position, enum aig_node_type *type,
+    uint64_t *index, uint64_t *variable_index) {
+
+  assert(aig != NULL);
+  assert(position < node_count(aig));
+
+  int rc = 0;
+
+  if (position < aig->input_count) {
+    if ((rc = parse_inputs(aig, position)))
+      return rc;
+    *type = AIG_INPUT;
+    *index = position;
+    *variable_index = get_input(aig, position) / 2;
+    return 0;
+  }
+  position -= aig->input_count;
+
+  if (position < aig->latch_count) {
+    if ((rc = parse_latches(aig, position)))
+      return rc;
+    *type = AIG_LATCH;
+    *index = position;
+    *variable_index = get_latch_current(aig, position) / 2;
+    return 0;
+  }
+  position -= aig->latch_count;
+
+  if ((rc = parse_ands(aig, position)))
+    return rc;
+  *type = AIG_AND_GATE;
+  *index = position;
+  *variable_index = get_and_lhs(aig, position) / 2;
+  return 0;
+}
+
+/** collect the variables defined by a list of exceptions
+ *
+ * \param ex Exceptions to read
+ * \param index_limit Maximum index that can be stored in ex
+ * \param value_limit Maximum value that can be stored in ex
+ * \param base Position of the first node the exceptions are relative to
+ * \param entries [out] Array to write into
+ * \returns Number of entries written
+ */
+static size_t collect(const exceptions_t *ex, uint64_t index_limit,
+    uint64_t value_limit, uint64_t base, entry_t *entries) {
+
+  assert(ex != NULL);
+
+  for (size_t i = 0; i < ex->count; i++) {
+    uint64_t index, value;
+    ex_get(ex, i, index_limit, value_limit, &index, &value);
+    entries[i] = (entry_t){ .variable_index = value / 2,
+                            .position = base + index };
+  }
+
+  return ex->count;
+}
+
+int node_map_build(aig_t *aig) {
+
+  assert(aig != NULL);
+
+  if (aig->node_map_built)
+    return 0;
+
+  // we need every exception, so ensure everything that can have one is parsed
+  int rc = parse_ands(aig, UINT64_MAX);
+  if (rc)
+    return rc;
+
+  size_t n = exception_count(aig);
+
+  // gather the variables whose defining node has an exception
+  entry_t *entries = NULL;
+  if (n > 0) {
+    entries = calloc(n, sizeof(entries[0]));
+    if (entries == NULL)
+      return ENOMEM;
+
+    size_t m = 0;
+    m += collect(&aig->inputs, aig->input_count, bb_limit(aig), 0,
+                 &entries[m]);
+    m += collect(&aig->latch_current, aig->latch_count, bb_limit(aig),
+                 aig->input_count, &entries[m]);
+    m += collect(&aig->and_lhs, aig->and_count, bb_limit(aig),
+                 aig->input_count + aig->latch_count, &entries[m]);
+    assert(m == n);
+
+    qsort(entries, n, sizeof(entries[0]), cmp_entry);
+  }
+
+  uint64_t total = node_count(aig);
+  for (size_t i = 0; i < n; i++) {
+
+    // if a variable is defined more than once, the first definition wins
+    if (i > 0 && entries[i].variable_index == entries[i - 1].variable_index)
+      continue;
+
+    if ((rc = ex_append(&aig->node_map, entries[i].variable_index,
+        entries[i].position, aig->max_index, total))) {
+      ex_reset(&aig->node_map);
+      free(entries);
+      return rc;
+    }
+  }
+
+  free(entries);
+
+  aig->node_map_built = 1;
+
+  return 0;
+}
+
+int node_map_find(aig_t *aig, uint64_t variable_index,
+    enum aig_node_type *type, uint64_t *index) {
+
+  assert(aig != NULL);
+  assert(variable_index > 0);
+  assert(type != NULL);
+  assert(index != NULL);
+
+  if (variable_index > aig->max_index)
+    return ERANGE;
+
+  int rc = 0;
+  uint64_t total = node_count(aig);
+  uint64_t v;
+
+  // try the node at the position implied by the variable index
+  uint64_t position = variable_index - 1;
+  bool inferred = false;
+  if (position < total) {
+    if ((rc = node_at(aig, position, type, index, &v)))
+      return rc;
+    inferred = v == variable_index;
+
+    // every node before this one is now parsed, so if none of them were out of
+    // sequence, none of them can have defined this variable first
+    if (inferred && exception_count(aig) == 0)
+      return 0;
+  }
+
+  // otherwise consult the map, which holds the first out of sequence node
+  // defining this variable
+  if ((rc = node_map_build(aig)))
+    return rc;
+
+  uint64_t p;
+  if (ex_find(&aig->node_map, variable_index, aig->max_index, total, &p)) {
+
+    // the first definition wins, whether it is out of sequence or not
+    if (!inferred || p < position)
+      position = p;
+
+  } else if (!inferred) {
+    return ERANGE;
+  }
+
+  if ((rc = node_at(aig, position, type, index, &v)))
+    return rc;
+  assert(v == variable_index && "node map out of sync with nodes");
+
+  return 0;
+}
+
+int node_map_first_ands(aig_t *aig, uint64_t **live) {
+
+  assert(aig != NULL);
+  assert(live != NULL);
+
+  uint64_t *defined = calloc((size_t)(aig->max_index / 64 + 1),
+                             sizeof(defined[0]));
+  uint64_t *l = calloc((size_t)(aig->and_count / 64 + 1), sizeof(l[0]));
+  int rc = 0;
+  if (defined == NULL || l == NULL) {
+    rc = ENOMEM;
+    goto done;
+  }
+
+  for (uint64_t i = 0; i < aig->input_count; i += BLOCK) {
+    uint64_t n = aig->input_count - i < BLOCK ? aig->input_count - i : BLOCK;
+    uint64_t inputs[BLOCK];
+    if ((rc = aig_get_inputs(aig, i, n, inputs)))
+      goto done;
+    for (uint64_t j = 0; j < n; j++) {
+      uint64_t v = inputs[j] / 2;
+      defined[v / 64] |= UINT64_C(1) << (v % 64);
+    }
+  }
+
+  for (uint64_t i = 0; i < aig->latch_count; i += BLOCK) {
+    uint64_t n = aig->latch_count - i < BLOCK ? aig->latch_count - i : BLOCK;
+    uint64_t current[BLOCK];
+    if ((rc = aig_get_latches(aig, i, n, current, NULL)))
+      goto done;
+    for (uint64_t j = 0; j < n; j++) {
+      uint64_t v = current[j] / 2;
+      defined[v / 64] |= UINT64_C(1) << (v % 64);
+    }
+  }
+
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint64_t lhs[BLOCK];
+    if ((rc = aig_get_ands(aig, i, n, lhs, NULL, NULL)))
+      goto done;
+    for (uint64_t j = 0; j < n; j++) {
+      uint64_t v = lhs[j] / 2;
+      if ((defined[v / 64] >> (v % 64)) & 1)
+        continue;
+      defined[v / 64] |= UINT64_C(1) << (v % 64);
+      l[(i + j) / 64] |= UINT64_C(1) << ((i + j) % 64);
+    }
+  }
+
+  *live = l;
+  l = NULL;
+
+done:
+  free(l);
+  free(defined);
+
+  return rc;
+}
@@ -0,0 +1,59 @@
+// abstraction for finding the node that defines a given variable index
+//
+// Most nodes in an AIG sit at the position their variable index implies:
+// variable v is defined by the (v - 1)th node counting through inputs, latches,
+// and then AND gates. The binary format guarantees this, and it is typical of
+// ASCII files too. So rather than a full reverse index, we keep a map of only
+// the variables whose defining node lies somewhere else. This is derived from
+// the exceptions recorded while parsing, so is empty for a fully inferable AIG.
+
+#pragma once
+
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <stdint.h>
+
+/** construct the map of variables not defined at their inferred position
+ *
+ * This parses every input, latch, and AND gate if they have not already been
+ * parsed. Calling this on an AIG whose map is already built is a no-op.
+ *
+ * \param aig AIG to operate on
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int node_map_build(aig_t *aig);
+
+/** find the node that defines a given variable index
+ *
+ * If a variable is defined more than once, the first definition in file order
+ * is returned. The node at the variable’s inferred position is tried first,
+ * and is returned directly if no earlier node was out of sequence, which only
+ * needs parsing up to that node. Otherwise the map is built, and hence the
+ * full AIG parsed.
+ *
+ * \param aig AIG to search
+ * \param variable_index Non-zero variable index to lookup
+ * \param type [out] Type of the defining node on success
+ * \param index [out] Index of the defining node within its type on success
+ * \returns 0 on success, ERANGE if no node defines this variable, or another
+ *   errno on failure
+ */
+__attribute__((visibility("internal")))
+int node_map_find(aig_t *aig, uint64_t variable_index,
+  enum aig_node_type *type, uint64_t *index);
+
+/** find which AND gates are the first definition of their variable
+ *
+ * A gate that redefines a variable some earlier node already defines is never
+ * used, as every reference to the variable means the earlier node. So nothing
+ * following edges from operands to gates should continue through it.
+ *
+ * \param aig AIG to examine
+ * \param live [out] Bitset over AND gate indices, where bit i % 64 of
+ *   live[i / 64] is set if gate i is the first definition of its variable, on
+ *   success. The caller is responsible for freeing this.
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int node_map_first_ands(aig_t *aig, uint64_t **live);
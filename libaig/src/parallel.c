@@ -0,0 +1,84 @@
+#include <assert.h>
+#include <errno.h>
+#include "parallel.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/// state shared between all threads of a parallel_for()
+typedef struct {
+  int (*fn)(void *arg, size_t task);
+  void *arg;
+
+  /// total number of tasks
+  size_t tasks;
+
+  /// next task to be claimed
+  size_t next;
+
+  /// an error from a failing task, or 0
+  int rc;
+} job_t;
+
+static void *worker(void *arg) {
+
+  assert(arg != NULL);
+
+  job_t *job = arg;
+
+  for (;;) {
+
+    // stop early if someone else has already failed
+    if (__atomic_load_n(&job->rc, __ATOMIC_RELAXED) != 0)
+      break;
+
+    // claim the next task
+    size_t task = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+    if (task >= job->tasks)
+      break;
+
+    int rc = job->fn(job->arg, task);
+    if (rc) {
+      int expected = 0;
+      (void)__atomic_compare_exchange_n(&job->rc, &expected, rc, false,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+  }
+
+  return NULL;
+}
+
+int parallel_for(size_t threads, size_t tasks, int (*fn)(void *arg,
+    size_t task), void *arg) {
+
+  assert(fn != NULL);
+
+  // there is no point having more threads than tasks
+  if (threads > tasks)
+    threads = tasks;
+
+  job_t job = { .fn = fn, .arg = arg, .tasks = tasks };
+
+  // start the helper threads, settling for however many we can create
+  pthread_t *helpers = NULL;
+  size_t started = 0;
+  if (threads > 1) {
+    helpers = calloc(threads - 1, sizeof(helpers[0]));
+    if (helpers != NULL) {
+      for (; started < threads - 1; started++) {
+        if (pthread_create(&helpers[started], NULL, worker, &job) != 0)
+          break;
+      }
+    }
+  }
+
+  // participate in the work ourselves
+  (void)worker(&job);
+
+  for (size_t i = 0; i < started; i++)
+    (void)pthread_join(helpers[i], NULL);
+  free(helpers);
+
+  return job.rc;
+}
@@ -0,0 +1,22 @@
+// minimal support for spreading independent tasks across threads
+
+#pragma once
+
+#include <stddef.h>
+
+/** run a function over a range of tasks, using multiple threads
+ *
+ * Tasks are handed out dynamically, so they do not need to be of equal cost.
+ * The calling thread participates in running tasks. If threads cannot be
+ * created, the remaining work is done by however many are running, so this
+ * function never fails for lack of threads.
+ *
+ * \param threads Maximum number of threads to use, including the caller
+ * \param tasks Number of tasks to run
+ * \param fn Function to run each task, returning 0 on success or an errno
+ * \param arg Opaque state to pass to fn
+ * \returns 0 on success or an errno from one of the failing tasks
+ */
+__attribute__((visibility("internal")))
+int parallel_for(size_t threads, size_t tasks, int (*fn)(void *arg,
+  size_t task), void *arg);
@@ -3,22 +3,28 @@
 #include "bitbuffer.h"
 #include <assert.h>
 #include <ctype.h>
+#include "deltabuffer.h"
 #include <errno.h>
+#include "exceptions.h"
 #include "infer.h"
+#include "lex.h"
 #include <limits.h>
+#include "parallel.h"
 #include "parse.h"
+#include "source.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
-static int read_char(FILE *f, char *out) {
+static int read_char(source_t *s, char *out) {
 
-  assert(f != NULL);
+  assert(s != NULL);
 
-  int c = getc(f);
+  int c = source_getc(s);
   if (c == EOF) {
-    int err = ferror(f);
+    int err = source_error(s);
     return err == 0 ? EILSEQ : err;
   }
 
@@ -26,37 +32,37 @@ static int read_char(FILE *f, char *out) {
   return 0;
 }
 
-static int skip(FILE *f, char e) {
+static int skip(source_t *s, char e) {
 
-  assert(f != NULL);
+  assert(s != NULL);
 
   char c;
-  int err = read_char(f, &c);
+  int err = read_char(s, &c);
   if (err != 0)
     return err;
 
   if (c != e) {
-    ungetc(c, f);
+    source_ungetc(s, c);
     return EILSEQ;
   }
 
   return 0;
 }
 
-static int skip_space(FILE *f) {
-  return skip(f, ' ');
+static int skip_space(source_t *s) {
+  return skip(s, ' ');
 }
 
-static int skip_newline(FILE *f) {
-  return skip(f, '\n');
+static int skip_newline(source_t *s) {
+  return skip(s, '\n');
 }
 
-static int skip_whitespace(FILE *f) {
+static int skip_whitespace(source_t *s) {
   bool read_one = false;
   for (; ; read_one = true) {
 
     char c;
-    int rc = read_char(f, &c);
+    int rc = read_char(s, &c);
     if (rc) {
       if (!read_one)
         return rc;
@@ -64,7 +70,7 @@ static int skip_whitespace(FILE *f) {
     }
 
     if (!isspace(c)) {
-      ungetc(c, f);
+      source_ungetc(s, c);
       break;
     }
   }
@@ -72,19 +78,49 @@ static int skip_whitespace(FILE *f) {
   return 0;
 }
 
-static int parse_num(FILE *f, uint64_t *out) {
+/** skip the line terminator preceding the AND gates section of a binary AIG
+ *
+ * Unlike skip_whitespace(), this stops after the first newline. The binary AND
+ * gates section that follows may contain bytes that look like white space.
+ *
+ * \param s Source to read from
+ * \param strict Whether to demand exact white space conformance
+ * \returns 0 on success or an errno on failure
+ */
+static int skip_binary_terminator(source_t *s, bool strict) {
+
+  assert(s != NULL);
+
+  // in non-strict mode, tolerate trailing white space before the newline
+  if (!strict) {
+    for (;;) {
+      char c;
+      int rc = read_char(s, &c);
+      if (rc)
+        return rc;
+      if (c == '\n' || !isspace(c)) {
+        source_ungetc(s, c);
+        break;
+      }
+    }
+  }
 
-  assert(f != NULL);
+  return skip_newline(s);
+}
+
+static int parse_num(source_t *s, uint64_t *out) {
+
+  assert(s != NULL);
   assert(out != NULL);
 
   int rc = 0;
 
   char c;
-  if ((rc = read_char(f, &c)))
+  if ((rc = read_char(s, &c)))
     return rc;
 
   if (!isdigit(c)) {
-    ungetc(c, f);
+    source_ungetc(s, c);
     return EILSEQ;
   }
 
@@ -93,7 +129,7 @@ static int parse_num(FILE *f, uint64_t *out) {
   for (;;) {
 
     char d;
-    if ((rc = read_char(f, &d))) {
+    if ((rc = read_char(s, &d))) {
       if (rc == EILSEQ) {
         rc = 0;
         break;
@@ -102,13 +138,13 @@ static int parse_num(FILE *f, uint64_t *out) {
     }
 
     if (!isdigit(d)) {
-      ungetc(d, f);
+      source_ungetc(s, d);
       break;
     }
 
     // would the upcoming arithmetic overflow?
     if ((UINT64_MAX - (uint64_t)(d - '0')) / 10 < v) {
-      ungetc(d, f);
+      source_ungetc(s, d);
       return EOVERFLOW;
     }
 
@@ -122,27 +158,27 @@ static int parse_num(FILE *f, uint64_t *out) {
 int parse_header(aig_t *aig) {
 
   assert(aig != NULL);
-  assert(aig->source != NULL);
+  assert(source_is_open(&aig->source));
 
   int rc = 0;
 
   // in non-strict mode, ignore any leading white space
   if (!aig->strict)
-    (void)skip_whitespace(aig->source);
+    (void)skip_whitespace(&aig->source);
 
   // the header should start with either "aag" for the ASCII format or "aig" for
   // the binary format
 
   char c;
-  if ((rc = read_char(aig->source, &c)))
+  if ((rc = read_char(&aig->source, &c)))
     return rc;
 
   if (c != 'a') {
-    ungetc(c, aig->source);
+    source_ungetc(&aig->source, c);
     return EILSEQ;
   }
 
-  if ((rc = read_char(aig->source, &c)))
+  if ((rc = read_char(&aig->source, &c)))
     return rc;
 
   if (c == 'a') {
@@ -150,57 +186,57 @@ int parse_header(aig_t *aig) {
   } else if (c == 'i') {
     aig->binary = 1;
   } else {
-    ungetc(c, aig->source);
+    source_ungetc(&aig->source, c);
     return EILSEQ;
   }
 
-  if ((rc = read_char(aig->source, &c)))
+  if ((rc = read_char(&aig->source, &c)))
     return rc;
 
   if (c != 'g') {
-    ungetc(c, aig->source);
+    source_ungetc(&aig->source, c);
     return EILSEQ;
   }
 
   // in non-strict mode, skip arbitrary amounts of white space instead of just a
   // single space
-  int (*skipper)(FILE*) = aig->strict ? skip_space : skip_whitespace;
+  int (*skipper)(source_t*) = aig->strict ? skip_space : skip_whitespace;
 
-  if ((rc = skipper(aig->source)))
+  if ((rc = skipper(&aig->source)))
     return rc;
 
   // now the M, I, L, O, A fields follow
 
-  if ((rc = parse_num(aig->source, &aig->max_index)))
+  if ((rc = parse_num(&aig->source, &aig->max_index)))
     return rc;
 
-  if ((rc = skipper(aig->source)))
+  if ((rc = skipper(&aig->source)))
     return rc;
 
-  if ((rc = parse_num(aig->source, &aig->input_count)))
+  if ((rc = parse_num(&aig->source, &aig->input_count)))
     return rc;
 
-  if ((rc = skipper(aig->source)))
+  if ((rc = skipper(&aig->source)))
     return rc;
 
-  if ((rc = parse_num(aig->source, &aig->latch_count)))
+  if ((rc = parse_num(&aig->source, &aig->latch_count)))
     return rc;
 
-  if ((rc = skipper(aig->source)))
+  if ((rc = skipper(&aig->source)))
     return rc;
 
-  if ((rc = parse_num(aig->source, &aig->output_count)))
+  if ((rc = parse_num(&aig->source, &aig->output_count)))
     return rc;
 
-  if ((rc = skipper(aig->source)))
+  if ((rc = skipper(&aig->source)))
     return rc;
 
-  if ((rc = parse_num(aig->source, &aig->and_count)))
+  if ((rc = parse_num(&aig->source, &aig->and_count)))
     return rc;
 
   // unconditionally strictly require a newline to follow, to ensure we fail to
   // load AIGER 1.9 files for now
-  if ((rc = skip_newline(aig->source)))
+  if ((rc = skip_newline(&aig->source)))
     return rc;
 
   return rc;
@@ -223,36 +259,26 @@ int parse_inputs(aig_t *aig, uint64_t upto) {
 
     // in non-strict mode, ignore leading white space
     if (!aig->strict)
-      (void)skip_whitespace(aig->source);
+      (void)skip_whitespace(&aig->source);
 
     // parse the input itself
     uint64_t n;
-    int rc = parse_num(aig->source, &n);
+    int rc = parse_num(&aig->source, &n);
     if (rc)
       return rc;
 
     // read the line terminator
-    rc = aig->strict ? skip_newline(aig->source) : skip_whitespace(aig->source);
+    rc = aig->strict ? skip_newline(&aig->source)
+                     : skip_whitespace(&aig->source);
     if (rc)
       return rc;
 
-    // if this input’s index is out of the expected (and inferable) sequence or
-    // we have existing input data indicating that a prior input had an index
-    // out of sequence, we will need to add it to the aig->inputs array
-    if (n != get_inferred_input(aig, i) || !bb_is_empty(&aig->inputs)) {
-
-      // if we have no input data, every input before this one had an inferable
-      // index, so we need to construct all this data now
-      if (bb_is_empty(&aig->inputs)) {
-        for (uint64_t j = 0; j < i; j++) {
-          uint64_t input = get_inferred_input(aig, j);
-          if ((rc = bb_append(&aig->inputs, input, bb_limit(aig))))
-            return rc;
-        }
-      }
-
-      // store this input
-      if ((rc = bb_append(&aig->inputs, n, bb_limit(aig))))
+    // if this input’s index is out of the expected (and inferable) sequence,
+    // record it as an exception
+    if (n != get_inferred_input(aig, i)) {
+      if (n > bb_limit(aig))
+        return ERANGE;
+      if ((rc = ex_append(&aig->inputs, i, n, aig->input_count, bb_limit(aig))))
         return rc;
     }
   }
@@ -286,7 +312,7 @@ int parse_latches(aig_t *aig, uint64_t upto) {
 
     // in non-strict mode, ignore leading white space
     if (!aig->strict)
-      (void)skip_whitespace(aig->source);
+      (void)skip_whitespace(&aig->source);
 
     uint64_t current;
     // the current state of the latch can be inferred in the binary format
@@ -296,18 +322,18 @@ int parse_latches(aig_t *aig, uint64_t upto) {
     } else {
 
       // parse the current state of the latch
-      if ((rc = parse_num(aig->source, &current)))
+      if ((rc = parse_num(&aig->source, &current)))
         return rc;
 
-      rc = aig->strict ? skip_space(aig->source)
-                       : skip_whitespace(aig->source);
+      rc = aig->strict ? skip_space(&aig->source)
+                       : skip_whitespace(&aig->source);
       if (rc)
         return rc;
     }
 
     // read the next state of the latch
     uint64_t next;
-    if ((rc = parse_num(aig->source, &next)))
+    if ((rc = parse_num(&aig->source, &next)))
       return rc;
 
     // fail if this exceeds the maximum variable index, as we rely on this to
@@ -316,29 +342,22 @@ int parse_latches(aig_t *aig, uint64_t upto) {
       return ERANGE;
 
     // read the line terminator
-    rc = aig->strict ? skip_newline(aig->source) : skip_whitespace(aig->source);
+    if (aig->binary && aig->output_count == 0 && i + 1 == aig->latch_count) {
+      rc = skip_binary_terminator(&aig->source, aig->strict);
+    } else {
+      rc = aig->strict ? skip_newline(&aig->source)
+                       : skip_whitespace(&aig->source);
+    }
     if (rc)
       return rc;
 
     // if this latch’s current value is out of the expected (and inferable)
-    // sequence or we have existing latch current data indicating that a prior
-    // latch had a current value out of sequence, we will need to add it to the
-    // aig->latch_current array
-    if (current != get_inferred_latch_current(aig, i)
-        || !bb_is_empty(&aig->latch_current)) {
-
-      // if we have no latch current data, every latch before this one had an
-      // inferable current value, so we need to construct all this data now
-      if (bb_is_empty(&aig->latch_current)) {
-        for (uint64_t j = 0; j < i; j++) {
-          uint64_t c = get_inferred_latch_current(aig, j);
-          if ((rc = bb_append(&aig->latch_current, c, bb_limit(aig))))
-            return rc;
-        }
-      }
-
-      // store this latch’s current value
-      if ((rc = bb_append(&aig->latch_current, current, bb_limit(aig))))
+    // sequence, record it as an exception
+    if (current != get_inferred_latch_current(aig, i)) {
+      if (current > bb_limit(aig))
+        return ERANGE;
+      if ((rc = ex_append(&aig->latch_current, i, current, aig->latch_count,
+          bb_limit(aig))))
         return rc;
     }
 
@@ -374,11 +393,11 @@ int parse_outputs(aig_t *aig, uint64_t upto) {
 
     // in non-strict mode, ignore leading white space
     if (!aig->strict)
-      (void)skip_whitespace(aig->source);
+      (void)skip_whitespace(&aig->source);
 
     // parse the current output
     uint64_t o;
-    int rc = parse_num(aig->source, &o);
+    int rc = parse_num(&aig->source, &o);
     if (rc)
       return rc;
 
@@ -387,7 +406,12 @@ int parse_outputs(aig_t *aig, uint64_t upto) {
       return ERANGE;
 
     // read the line terminator
-    rc = aig->strict ? skip_newline(aig->source) : skip_whitespace(aig->source);
+    if (aig->binary && aig->index + 1 == aig->output_count) {
+      rc = skip_binary_terminator(&aig->source, aig->strict);
+    } else {
+      rc = aig->strict ? skip_newline(&aig->source)
+                       : skip_whitespace(&aig->source);
+    }
     if (rc)
       return rc;
 
@@ -399,40 +423,110 @@ int parse_outputs(aig_t *aig, uint64_t upto) {
   return 0;
 }
 
+/** store a parsed AND gate
+ *
+ * \param aig Data structure to store into
+ * \param index Index of the AND gate
+ * \param lhs Encoded LHS of the gate
+ * \param rhs0 Encoded first operand of the gate
+ * \param rhs1 Encoded second operand of the gate
+ * \returns 0 on success or an errno on failure
+ */
+static int store_and(aig_t *aig, uint64_t index, uint64_t lhs, uint64_t rhs0,
+    uint64_t rhs1) {
+
+  assert(aig != NULL);
+
+  // is the LHS an encoding of a legal variable index?
+  if (lhs > bb_limit(aig))
+    return ERANGE;
+
+  int rc = 0;
+
+  // if this AND gate’s LHS is out of the expected (and inferable) sequence,
+  // record it as an exception
+  if (lhs != get_inferred_and_lhs(aig, index)) {
+    if ((rc = ex_append(&aig->and_lhs, index, lhs, aig->and_count,
+        bb_limit(aig))))
+      return rc;
+  }
+
+  // is the RHS an encoding of a legal variable index?
+  if (rhs0 > bb_limit(aig) || rhs1 > bb_limit(aig))
+    return ERANGE;
+
+  // in compressed mode, store the RHSs relative to the LHS
+  if (aig->compress) {
+    if ((rc = db_append(&aig->and_rhs_deltas, lhs, rhs0)))
+      return rc;
+    if ((rc = db_append(&aig->and_rhs_deltas, lhs, rhs1)))
+      return rc;
+    return 0;
+  }
+
+  // store the RHSs values in the AND gates array
+  if ((rc = bb_append(&aig->and_rhs, rhs0, bb_limit(aig))))
+    return rc;
+  if ((rc = bb_append(&aig->and_rhs, rhs1, bb_limit(aig))))
+    return rc;
+
+  return 0;
+}
+
 static int parse_and_ascii(aig_t *aig, uint64_t index) {
 
   assert(aig != NULL);
 
+  // if we are reading from memory, try to lex the entire line in one go
+  if (aig->source.base != NULL) {
+    const char *base = aig->source.base;
+    const char *cursor = base + aig->source.offset;
+    const char *end = base + aig->source.size;
+
+    uint64_t lhs, rhs0, rhs1;
+    if (lex_and(&cursor, end, aig->strict, &lhs, &rhs0, &rhs1)) {
+      aig->source.offset = (size_t)(cursor - base);
+
+      // are these encodings of legal variable indices?
+      if (rhs0 > bb_limit(aig) || rhs1 > bb_limit(aig))
+        return ERANGE;
+
+      return store_and(aig, index, lhs, rhs0, rhs1);
+    }
+
+    // otherwise, fall back to the general parser below
+  }
+
   // in non-strict mode, ignore leading white space
   if (!aig->strict)
-    (void)skip_whitespace(aig->source);
+    (void)skip_whitespace(&aig->source);
 
   // parse the index of the AND gate
   uint64_t lhs;
-  int rc = parse_num(aig->source, &lhs);
+  int rc = parse_num(&aig->source, &lhs);
   if (rc)
     return rc;
 
-  rc = aig->strict ? skip_space(aig->source) : skip_whitespace(aig->source);
+  rc = aig->strict ? skip_space(&aig->source) : skip_whitespace(&aig->source);
   if (rc)
     return rc;
 
   // read the first operand
   uint64_t rhs0;
-  if ((rc = parse_num(aig->source, &rhs0)))
+  if ((rc = parse_num(&aig->source, &rhs0)))
     return rc;
 
   // is this an encoding of a legal variable index?
   if (rhs0 > bb_limit(aig))
     return ERANGE;
 
-  rc = aig->strict ? skip_space(aig->source) : skip_whitespace(aig->source);
+  rc = aig->strict ? skip_space(&aig->source) : skip_whitespace(&aig->source);
   if (rc)
     return rc;
 
   // read the second operand
   uint64_t rhs1;
-  if ((rc = parse_num(aig->source, &rhs1)))
+  if ((rc = parse_num(&aig->source, &rhs1)))
     return rc;
 
   // is this an encoding of a legal variable index?
@@ -440,43 +534,88 @@ static int parse_and_ascii(aig_t *aig, uint64_t index) {
     return ERANGE;
 
   // read the line terminator
-  rc = aig->strict ? skip_newline(aig->source) : skip_whitespace(aig->source);
+  rc = aig->strict ? skip_newline(&aig->source) : skip_whitespace(&aig->source);
   if (rc)
     return rc;
 
-  // if this AND gate’s LHS is out of the expected (and inferable) sequence or
-  // we have existing LHS data indicating that a prior gate had an LHS out of
-  // sequence, we will need to add it to the aig->and_lhs array
-  if (lhs != get_inferred_and_lhs(aig, index) || !bb_is_empty(&aig->and_lhs)) {
-
-    // if we have no LHS data, every AND gate before this one had an inferable
-    // LHS, so we need to construct all this data now
-    if (bb_is_empty(&aig->and_lhs)) {
-      for (uint64_t i = 0; i < index; i++) {
-        uint64_t l = get_inferred_and_lhs(aig, i);
-        if ((rc = bb_append(&aig->and_lhs, l, bb_limit(aig))))
-          return rc;
-      }
-    }
+  return store_and(aig, index, lhs, rhs0, rhs1);
+}
+
+/** parse a variable-length encoded delta from a binary AIG
+ *
+ * The binary format encodes each delta as a sequence of bytes, least
+ * significant 7 bits first, with the high bit of each byte indicating whether
+ * another byte follows.
+ *
+ * \param s Source to read from
+ * \param out [out] The decoded delta on success
+ * \returns 0 on success or an errno on failure
+ */
+static int parse_delta(source_t *s, uint64_t *out) {
+
+  assert(s != NULL);
+  assert(out != NULL);
+
+  uint64_t v = 0;
+
+  for (unsigned shift = 0; ; shift += 7) {
 
-    // store the current LHS
-    if ((rc = bb_append(&aig->and_lhs, lhs, bb_limit(aig))))
+    char c;
+    int rc = read_char(s, &c);
+    if (rc)
       return rc;
-  }
 
-  // store the RHSs values in the AND gates array
-  if ((rc = bb_append(&aig->and_rhs, rhs0, bb_limit(aig))))
-    return rc;
-  if ((rc = bb_append(&aig->and_rhs, rhs1, bb_limit(aig))))
-    return rc;
+    uint8_t byte = (uint8_t)c;
+    uint64_t bits = byte & 0x7f;
+
+    // would these bits overflow the value we are accumulating?
+    if (shift >= 64 || (bits << shift) >> shift != bits)
+      return EOVERFLOW;
+
+    v |= bits << shift;
+
+    // is this the last byte of the encoding?
+    if (!(byte & 0x80))
+      break;
+  }
 
+  *out = v;
   return 0;
 }
 
 static int parse_and_binary(aig_t *aig, uint64_t index) {
-  (void)aig;
-  (void)index;
-  return ENOTSUP;
+
+  assert(aig != NULL);
+
+  // the LHS of AND gates in the binary format is implicit
+  uint64_t lhs = get_inferred_and_lhs(aig, index);
+
+  // read the difference between the LHS and the first operand
+  uint64_t delta0;
+  int rc = parse_delta(&aig->source, &delta0);
+  if (rc)
+    return rc;
+
+  // the first operand must be strictly less than the LHS
+  if (delta0 > lhs || (aig->strict && delta0 == 0))
+    return ERANGE;
+  uint64_t rhs0 = lhs - delta0;
+
+  // is this an encoding of a legal variable index?
+  if (rhs0 > bb_limit(aig))
+    return ERANGE;
+
+  // read the difference between the first operand and the second
+  uint64_t delta1;
+  if ((rc = parse_delta(&aig->source, &delta1)))
+    return rc;
+
+  // the second operand must be less than or equal to the first
+  if (delta1 > rhs0)
+    return ERANGE;
+  uint64_t rhs1 = rhs0 - delta1;
+
+  return store_and(aig, index, lhs, rhs0, rhs1);
 }
 
 static int parse_and(aig_t *aig, uint64_t index) {
@@ -484,6 +623,326 @@ static int parse_and(aig_t *aig, uint64_t index) {
                      : parse_and_ascii(aig, index);
 }
 
+/// minimum number of bytes worth handing to a thread for parallel parsing
+enum { MIN_CHUNK_SIZE = 1 << 20 };
+
+/// a portion of the AND gates section being parsed in parallel
+typedef struct {
+
+  /// offsets in the source of the first byte and one past the last byte this
+  /// chunk covers
+  size_t start;
+  size_t end;
+
+  /// offset in the source just past the last gate lexed
+  size_t stop;
+
+  /// number of gates lexed when counting, and then the number to store
+  uint64_t count;
+
+  /// index of the first gate to store
+  uint64_t first;
+
+  /// RHSs of the stored gates, written directly into aig->and_rhs
+  bb_run_t rhs;
+
+  /// LHSs of the stored gates that differ from their inferred value
+  exceptions_t lhs;
+
+} chunk_t;
+
+/// state shared between threads parsing chunks
+typedef struct {
+  aig_t *aig;
+  chunk_t *chunks;
+} chunks_t;
+
+/** count the AND gates within a chunk
+ *
+ * This stops at the end of the chunk, at anything the fast lexer does not
+ * accept, at any out of range value, or once it has seen as many gates as
+ * remain to be parsed. The caller is responsible for noticing this and falling
+ * back to the general parser.
+ *
+ * \param arg Chunks being parsed
+ * \param task Index of the chunk to count
+ * \returns 0 on success or an errno on failure
+ */
+static int count_chunk(void *arg, size_t task) {
+
+  assert(arg != NULL);
+
+  const chunks_t *cs = arg;
+  const aig_t *aig = cs->aig;
+  chunk_t *c = &cs->chunks[task];
+
+  const char *cursor = aig->source.base + c->start;
+  const char *end = aig->source.base + c->end;
+  const char *limit = aig->source.base + aig->source.size;
+  uint64_t remaining = aig->and_count - aig->index;
+
+  c->stop = c->start;
+  while (cursor < end && c->count < remaining) {
+
+    // note that the last gate may extend beyond the end of the chunk
+    uint64_t lhs, rhs0, rhs1;
+    if (!lex_and(&cursor, limit, aig->strict, &lhs, &rhs0, &rhs1))
+      break;
+
+    if (lhs > bb_limit(aig) || rhs0 > bb_limit(aig) || rhs1 > bb_limit(aig))
+      break;
+
+    ++c->count;
+    c->stop = (size_t)(cursor - aig->source.base);
+  }
+
+  return 0;
+}
+
+/** store the AND gates within a chunk
+ *
+ * The chunk’s gates must have been previously counted by count_chunk().
+ *
+ * \param arg Chunks being parsed
+ * \param task Index of the chunk to store
+ * \returns 0 on success or an errno on failure
+ */
+static int store_chunk(void *arg, size_t task) {
+
+  assert(arg != NULL);
+
+  const chunks_t *cs = arg;
+  aig_t *aig = cs->aig;
+  chunk_t *c = &cs->chunks[task];
+
+  const char *cursor = aig->source.base + c->start;
+  const char *limit = aig->source.base + aig->source.size;
+
+  for (uint64_t i = c->first; i < c->first + c->count; i++) {
+
+    uint64_t lhs, rhs0, rhs1;
+    bool r __attribute__((unused))
+      = lex_and(&cursor, limit, aig->strict, &lhs, &rhs0, &rhs1);
+    assert(r && "failed to re-lex previously lexed gate");
+
+    // record the LHS if it is out of sequence, as store_and() does
+    if (lhs != get_inferred_and_lhs(aig, i)) {
+      int rc = ex_append(&c->lhs, i, lhs, aig->and_count, bb_limit(aig));
+      if (rc)
+        return rc;
+    }
+
+    bb_run_append(&aig->and_rhs, &c->rhs, rhs0, bb_limit(aig));
+    bb_run_append(&aig->and_rhs, &c->rhs, rhs1, bb_limit(aig));
+  }
+
+  c->stop = (size_t)(cursor - aig->source.base);
+
+  return 0;
+}
+
+/** find the start of the next line at or after the given offset
+ *
+ * In non-strict mode, this skips lines beginning with white space, which may
+ * be the continuation of white space the previous line’s parse consumes.
+ *
+ * \param aig AIG whose source to scan
+ * \param offset Offset to start searching from
+ * \returns The offset of a line start or the size of the source if none
+ */
+static size_t next_line(const aig_t *aig, size_t offset) {
+
+  assert(aig != NULL);
+
+  const char *base = aig->source.base;
+  size_t size = aig->source.size;
+
+  while (offset < size) {
+    const char *nl = memchr(base + offset, '\n', size - offset);
+    if (nl == NULL)
+      return size;
+    offset = (size_t)(nl - base) + 1;
+    if (aig->strict || offset == size || !isspace(base[offset]))
+      return offset;
+  }
+
+  return size;
+}
+
+/** find where the AND gates section ends
+ *
+ * Every AND gate line begins with a digit, while the symbol table and comment
+ * section that follow begin with a letter. So this binary searches line starts
+ * for the first that does not begin with a digit. Lines in the comment section
+ * can begin with anything, so the result may lie beyond the true end, but
+ * never before it.
+ *
+ * \param aig AIG whose source to scan
+ * \param start Offset of a line start within the AND gates section
+ * \returns The offset of the end of the section
+ */
+static size_t ands_end(const aig_t *aig, size_t start) {
+
+  assert(aig != NULL);
+
+  const char *base = aig->source.base;
+
+  // lo is always a line start within the section, and hi either a line start
+  // beyond it or the end of the source
+  size_t lo = start;
+  size_t hi = aig->source.size;
+  for (;;) {
+    size_t mid = next_line(aig, lo + (hi - lo) / 2);
+
+    // if there is no line start in the upper half, try the line after lo
+    if (mid >= hi) {
+      mid = next_line(aig, lo);
+      if (mid >= hi)
+        return hi;
+    }
+
+    if (isdigit(base[mid])) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+}
+
+/** parse the remainder of an in-memory ASCII AND gates section in parallel
+ *
+ * The remainder of the section is split into chunks at line boundaries, whose
+ * gates are counted independently on multiple threads. Each chunk is only
+ * accepted if the previous one finished exactly where it began. The accepted
+ * chunks are then parsed again on multiple threads, with each storing its
+ * gates directly into their final position. Anything this does not get
+ * through is left for the sequential parser to pick up.
+ *
+ * \param aig Data structure to read from and into
+ * \returns 0 on success or an errno on failure
+ */
+static int parse_ands_parallel(aig_t *aig) {
+
+  assert(aig != NULL);
+  assert(!aig->binary);
+  assert(!aig->compress);
+  assert(aig->source.base != NULL);
+  assert(aig->state == IN_ANDS);
+
+  size_t start = aig->source.offset;
+  size_t end = ands_end(aig, start);
+  size_t remaining = end - start;
+
+  // use a few chunks per thread, to balance the load
+  size_t chunk_count = aig->threads * 4;
+  if (remaining / MIN_CHUNK_SIZE < chunk_count)
+    chunk_count = remaining / MIN_CHUNK_SIZE;
+
+  // is there not enough work to make this worthwhile?
+  if (chunk_count < 2)
+    return 0;
+
+  chunk_t *chunks = calloc(chunk_count, sizeof(chunks[0]));
+  if (chunks == NULL)
+    return ENOMEM;
+
+  // divide the section into chunks of roughly equal size
+  size_t n = 0;
+  for (size_t offset = start; offset < end; n++) {
+    assert(n < chunk_count);
+    chunks[n].start = offset;
+    size_t target = start + remaining / chunk_count * (n + 1);
+    if (n + 1 == chunk_count || target <= offset) {
+      offset = end;
+    } else {
+      offset = next_line(aig, target);
+      if (offset > end)
+        offset = end;
+    }
+    chunks[n].end = offset;
+  }
+
+  chunks_t cs = { .aig = aig, .chunks = chunks };
+  int rc = parallel_for(aig->threads, n, count_chunk, &cs);
+  if (rc)
+    goto done;
+
+  // accept every chunk that lines up with its predecessor, numbering its gates
+  // and finding where in aig->and_rhs its RHSs will go
+  size_t width = bb_entry_width(bb_limit(aig));
+  size_t accepted = 0;
+  uint64_t total = 0;
+  for (size_t offset = start; accepted < n; ) {
+    chunk_t *c = &chunks[accepted];
+
+    if (c->start != offset)
+      break;
+
+    // if this chunk has more gates than we need, only store those we do
+    bool full = c->count >= aig->and_count - aig->index - total;
+    if (full)
+      c->count = aig->and_count - aig->index - total;
+
+    c->first = aig->index + total;
+    bb_run_start(&c->rhs, aig->and_rhs.size + total * 2 * width);
+    total += c->count;
+    ++accepted;
+
+    // if this chunk did not make it to its end, the rest is not trustworthy
+    if (full || c->stop < c->end)
+      break;
+
+    offset = c->stop;
+  }
+
+  if (total == 0)
+    goto done;
+
+  if ((rc = bb_run_reserve(&aig->and_rhs, total * 2, bb_limit(aig))))
+    goto done;
+
+  if ((rc = parallel_for(aig->threads, accepted, store_chunk, &cs))) {
+    bb_run_discard(&aig->and_rhs);
+    goto done;
+  }
+
+  // make room for the chunks’ exceptions, so appending them cannot fail and
+  // leave only some of the chunks stored
+  size_t exceptions = 0;
+  for (size_t i = 0; i < accepted; i++)
+    exceptions += chunks[i].lhs.count;
+  if ((rc = ex_reserve(&aig->and_lhs, exceptions, aig->and_count,
+      bb_limit(aig)))) {
+    bb_run_discard(&aig->and_rhs);
+    goto done;
+  }
+
+  for (size_t i = 0; i < accepted; i++) {
+    const chunk_t *c = &chunks[i];
+
+    for (size_t j = 0; j < c->lhs.count; j++) {
+      uint64_t index, lhs;
+      ex_get(&c->lhs, j, aig->and_count, bb_limit(aig), &index, &lhs);
+      int r __attribute__((unused))
+        = ex_append(&aig->and_lhs, index, lhs, aig->and_count, bb_limit(aig));
+      assert(r == 0 && "append failed despite reservation");
+    }
+
+    bb_run_commit(&aig->and_rhs, &c->rhs);
+  }
+
+  // resume the sequential parser from wherever we got to
+  aig->index += total;
+  aig->source.offset = chunks[accepted - 1].stop;
+
+done:
+  for (size_t i = 0; i < chunk_count; i++)
+    ex_reset(&chunks[i].lhs);
+  free(chunks);
+
+  return rc;
+}
+
 int parse_ands(aig_t *aig, uint64_t upto) {
 
   // if we have not yet parsed inputs, latches, and outputs we need to first
@@ -502,12 +961,27 @@ int parse_ands(aig_t *aig, uint64_t upto) {
   if (aig->state == IN_ANDS && aig->index > upto)
     return 0;
 
+  // if we are parsing the rest of an in-memory ASCII AIG into uncompressed
+  // storage, try to do as much of it in parallel as we can
+  if (aig->threads > 1 && !aig->binary && !aig->compress
+      && aig->source.base != NULL
+      && upto >= aig->and_count - 1 && aig->index < aig->and_count) {
+    int rc = parse_ands_parallel(aig);
+    if (rc)
+      return rc;
+  }
+
   for (; aig->index < aig->and_count && aig->index <= upto; aig->index++) {
     int rc = parse_and(aig, aig->index);
     if (rc)
       return rc;
   }
 
+  // if we have now seen every AND gate, the compressed RHS storage will not
+  // grow further, so trim any slack from its allocations
+  if (aig->compress && aig->index == aig->and_count)
+    db_shrink(&aig->and_rhs_deltas);
+
   return 0;
 }
 
@@ -540,10 +1014,10 @@ int parse_symtab(aig_t *aig, uint64_t upto) {
 
     // in non-strict mode, ignore leading white space
     if (!aig->strict)
-      (void)skip_whitespace(aig->source);
+      (void)skip_whitespace(&aig->source);
 
     char c;
-    int rc = read_char(aig->source, &c);
+    int rc = read_char(&aig->source, &c);
     if (rc == EILSEQ) { // EOF
       aig->state = DONE;
       return 0;
@@ -559,13 +1033,13 @@ int parse_symtab(aig_t *aig, uint64_t upto) {
 
     // is this a illegal category for a symbol?
     if (c != 'i' && c != 'l' && c != 'o') {
-      ungetc(c, aig->source);
+      source_ungetc(&aig->source, c);
       return EILSEQ;
     }
 
     // parse the position of the symbol
     uint64_t pos;
-    if ((rc = parse_num(aig->source, &pos)))
+    if ((rc = parse_num(&aig->source, &pos)))
       return rc;
 
     // is the position a illegal index?
@@ -577,7 +1051,7 @@ int parse_symtab(aig_t *aig, uint64_t upto) {
       return ERANGE;
 
     // skip the space in between the position and the symbol name
-    rc = aig->strict ? skip_space(aig->source) : skip_whitespace(aig->source);
+    rc = aig->strict ? skip_space(&aig->source) : skip_whitespace(&aig->source);
     if (rc)
       return rc;
 
@@ -598,7 +1072,7 @@ int parse_symtab(aig_t *aig, uint64_t upto) {
 
     // now read the symbol name into the buffer
     char s;
-    while (!(rc = read_char(aig->source, &s))) {
+    while (!(rc = read_char(&aig->source, &s))) {
       if (s == '\n')
         break;
       if (putc(s, b) == EOF) {
@@ -2,13 +2,16 @@
 #include "aig_t.h"
 #include <assert.h>
 #include <errno.h>
-#include <inttypes.h>
-#include "node_iter.h"
+#include "node_map.h"
+#include "sink.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/// number of latches or AND gates to decode at once
+enum { BLOCK = 256 };
+
 int aig_to_sat_string(aig_t *aig, char **sat) {
 
   if (aig == NULL)
@@ -39,64 +42,60 @@ int aig_to_sat_string(aig_t *aig, char **sat) {
   return 0;
 }
 
-/** write the term corresponding to a variable index to the given file
+/** write the term corresponding to a variable index to the given sink
  *
  * \param index Variable index to reference
- * \param f Output stream to write to
+ * \param s Output to write to
  * \returns 0 on success or an errno on failure
  */
-static int index_to_sat_term(uint64_t index, FILE *f) {
+static int index_to_sat_term(uint64_t index, sink_t *s) {
 
-  assert(f != NULL);
+  assert(s != NULL);
 
-  if (fprintf(f, "s%" PRIu64, index) < 0)
-    return errno;
+  int rc = sink_write(s, "s", 1);
+  if (rc)
+    return rc;
 
-  return 0;
+  return sink_uint(s, index);
 }
 
-/** write the term corresponding to a node to the given file
+/** write the term corresponding to a node to the given sink
  *
  * \param node Node to inspect
- * \param f Output stream to write to
+ * \param s Output to write to
  * \returns 0 on success or an errno on failure
  */
-static int node_to_sat_term(const struct aig_node *node, FILE *f) {
+static int node_to_sat_term(const struct aig_node *node, sink_t *s) {
 
   assert(node != NULL);
-  assert(f != NULL);
+  assert(s != NULL);
 
   int rc = 0;
 
   switch (node->type) {
 
     case AIG_CONSTANT:
-      if (node->constant.is_true) {
-        if (fprintf(f, "True") < 0)
-          return errno;
-      } else {
-        if (fprintf(f, "False") < 0)
-          return errno;
-      }
+      if ((rc = sink_puts(s, node->constant.is_true ? "True" : "False")))
+        return rc;
       break;
 
     case AIG_INPUT:
-      if ((rc = index_to_sat_term(node->input.variable_index, f)))
+      if ((rc = index_to_sat_term(node->input.variable_index, s)))
         return rc;
       break;
 
     case AIG_OUTPUT:
-      if ((rc = index_to_sat_term(node->output.variable_index, f)))
+      if ((rc = index_to_sat_term(node->output.variable_index, s)))
         return rc;
       break;
 
     case AIG_LATCH:
-      if ((rc = index_to_sat_term(node->latch.current, f)))
+      if ((rc = index_to_sat_term(node->latch.current, s)))
         return rc;
       break;
 
     case AIG_AND_GATE:
-      if ((rc = index_to_sat_term(node->and_gate.lhs, f)))
+      if ((rc = index_to_sat_term(node->and_gate.lhs, s)))
         return rc;
       break;
 
@@ -119,54 +118,77 @@ static const char *node_name(const struct aig_node *node) {
   }
 }
 
-/** write the definition corresponding to a node to the given file
+#define PR(str) do { if ((rc = sink_puts(s, str))) return rc; } while (0)
+
+/** write the definition corresponding to a node to the given sink
  *
  * \param node Node to inspect
- * \param f Output stream to write to
+ * \param s Output to write to
  * \returns 0 on success or an errno on failure
  */
-static int node_to_sat_define(const struct aig_node *node, FILE *f) {
+static int node_to_sat_define(const struct aig_node *node, sink_t *s) {
 
   assert(node != NULL);
-  assert(f != NULL);
+  assert(s != NULL);
 
   // True and False do not need to be defined
   if (node->type == AIG_CONSTANT)
     return 0;
 
-  if (fprintf(f, "(declare-fun ") < 0)
-    return errno;
+  int rc = 0;
 
-  int rc = node_to_sat_term(node, f);
-  if (rc)
+  PR("(declare-fun ");
+
+  if ((rc = node_to_sat_term(node, s)))
     return rc;
 
-  if (fprintf(f, " () Bool)") < 0)
-    return errno;
+  PR(" () Bool)");
 
   // append the name as a comment, if it exists
   const char *name = node_name(node);
   if (name != NULL) {
-    if (fprintf(f, " ; %s", name) < 0)
-      return errno;
+    PR(" ; ");
+    PR(name);
   }
 
-  if (fprintf(f, "\n") < 0)
-    return errno;
+  PR("\n");
+
+  return 0;
+}
+
+/** write a possibly negated variable to the given sink
+ *
+ * \param index Variable index to reference
+ * \param negated Whether to negate it
+ * \param s Output to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int operand_to_sat(uint64_t index, bool negated, sink_t *s) {
+
+  assert(s != NULL);
+
+  int rc = 0;
+
+  if (negated)
+    PR("(not ");
+  if ((rc = index_to_sat_term(index, s)))
+    return rc;
+  if (negated)
+    PR(")");
 
   return 0;
 }
 
-/** write the constraint corresponding to a node to the given file
+/** write the constraint corresponding to a node to the given sink
  *
  * \param node Node to inspect
- * \param f Output stream to write to
+ * \param s Output to write to
  * \returns 0 on success or an errno on failure
  */
-static int node_to_sat_constraint(const struct aig_node *node, FILE *f) {
+static int node_to_sat_constraint(const struct aig_node *node, sink_t *s) {
 
   assert(node != NULL);
-  assert(f != NULL);
+  assert(s != NULL);
 
   // no constraint for True, False, inputs or outputs
   if (node->type == AIG_CONSTANT)
@@ -176,12 +198,11 @@ static int node_to_sat_constraint(const struct aig_node *node, FILE *f) {
   if (node->type == AIG_OUTPUT)
     return 0;
 
-#define PR(args...) do { if (fprintf(f, args) < 0) return errno; } while (0)
+  int rc = 0;
 
   PR("(assert (= ");
 
-  int rc = 0;
-  if ((rc = node_to_sat_term(node, f)))
+  if ((rc = node_to_sat_term(node, s)))
     return rc;
 
   PR(" ");
@@ -189,29 +210,19 @@ static int node_to_sat_constraint(const struct aig_node *node, FILE *f) {
   switch (node->type) {
 
     case AIG_LATCH:
-      if (node->latch.next_negated)
-        PR("(not ");
-      if ((rc = index_to_sat_term(node->latch.next, f)))
+      if ((rc = operand_to_sat(node->latch.next, node->latch.next_negated, s)))
         return rc;
-      if (node->latch.next_negated)
-        PR(")");
       break;
 
     case AIG_AND_GATE:
       PR("(and ");
-      if (node->and_gate.negated[0])
-        PR("(not ");
-      if ((rc = index_to_sat_term(node->and_gate.rhs[0], f)))
+      if ((rc = operand_to_sat(node->and_gate.rhs[0],
+                               node->and_gate.negated[0], s)))
         return rc;
-      if (node->and_gate.negated[0])
-        PR(")");
       PR(" ");
-      if (node->and_gate.negated[1])
-        PR("(not ");
-      if ((rc = index_to_sat_term(node->and_gate.rhs[1], f)))
+      if ((rc = operand_to_sat(node->and_gate.rhs[1],
+                               node->and_gate.negated[1], s)))
         return rc;
-      if (node->and_gate.negated[1])
-        PR(")");
       PR(")");
       break;
 
@@ -221,81 +232,278 @@ static int node_to_sat_constraint(const struct aig_node *node, FILE *f) {
 
   PR("))\n");
 
+  return 0;
+}
+
 #undef PR
 
-  return 0;
+/** find the next variable in a cone of influence
+ *
+ * \param cone Bitset of variables in the cone
+ * \param words Number of words in cone
+ * \param word [in,out] Index of the word being scanned
+ * \param bits [in,out] Bits of that word not yet visited
+ * \param variable_index [out] The next variable on success
+ * \returns True if there was another variable
+ */
+static bool next_in_cone(const uint64_t *cone, size_t words, size_t *word,
+    uint64_t *bits, uint64_t *variable_index) {
+
+  assert(cone != NULL);
+  assert(word != NULL);
+  assert(bits != NULL);
+  assert(variable_index != NULL);
+
+  while (*bits == 0) {
+    if (++*word >= words)
+      return false;
+    *bits = cone[*word];
+  }
+
+  *variable_index = *word * 64 + (uint64_t)__builtin_ctzll(*bits);
+  *bits &= *bits - 1;
+  return true;
 }
 
-// has_next() behaviour for an iterator over nodes for SAT production
-static bool has_next(const aig_node_iter_t *it) {
+/** write declarations for every input, latch, and AND gate
+ *
+ * Only inputs and latches have names, so only they are retrieved individually.
+ * AND gates are decoded in blocks, and only as far as their LHS.
+ *
+ * \param aig AIG to translate
+ * \param s Output to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int write_defines(aig_t *aig, sink_t *s) {
 
-  assert(it != NULL);
+  assert(aig != NULL);
+  assert(s != NULL);
 
-  if (it->aig == NULL)
-    return false;
+  int rc = 0;
 
-  const aig_t *aig = it->aig;
+  for (uint64_t i = 0; i < aig->input_count; i++) {
+    struct aig_node n;
+    if ((rc = aig_get_input(aig, i, &n)))
+      return rc;
+    if ((rc = node_to_sat_define(&n, s)))
+      return rc;
+  }
 
-  // if the current index is out of range, we are exhausted
-  if (it->index >= aig->input_count + aig->latch_count + aig->and_count)
-    return false;
+  for (uint64_t i = 0; i < aig->latch_count; i++) {
+    struct aig_node n;
+    if ((rc = aig_get_latch(aig, i, &n)))
+      return rc;
+    if ((rc = node_to_sat_define(&n, s)))
+      return rc;
+  }
 
-  // otherwise, there is more to consume
-  return true;
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint64_t lhs[BLOCK];
+    if ((rc = aig_get_ands(aig, i, n, lhs, NULL, NULL)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      struct aig_node node = { .type = AIG_AND_GATE,
+                               .and_gate.lhs = lhs[j] / 2 };
+      if ((rc = node_to_sat_define(&node, s)))
+        return rc;
+    }
+  }
+
+  return 0;
 }
 
-// next() behaviour for an iterator over nodes for SAT production
-static int next(aig_node_iter_t *it, struct aig_node *item) {
+/** write declarations for the inputs, latches, and AND gates in a cone
+ *
+ * Only the variables in the cone are visited, each through the node that
+ * first defines it. So the names of inputs and latches outside the cone are
+ * never retrieved, and AND gates are not decoded at all.
+ *
+ * \param aig AIG to translate
+ * \param cone Bitset of variables to emit
+ * \param s Output to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int write_cone_defines(aig_t *aig, const uint64_t *cone, sink_t *s) {
 
-  assert(it != NULL);
-  assert(item != NULL);
-  assert(aig_iter_has_next(it));
+  assert(aig != NULL);
+  assert(cone != NULL);
+  assert(s != NULL);
 
-  if (it->aig == NULL)
-    return EINVAL;
+  int rc = 0;
 
-  uint64_t index = it->index;
+  size_t words = (size_t)(aig->max_index / 64 + 1);
+  size_t word = 0;
+  uint64_t bits = cone[0] & ~UINT64_C(1); // skip the constant
+  uint64_t v;
+  while (next_in_cone(cone, words, &word, &bits, &v)) {
+
+    enum aig_node_type type;
+    uint64_t index;
+    rc = node_map_find(aig, v, &type, &index);
+    if (rc == ERANGE) // used but never defined
+      continue;
+    if (rc)
+      return rc;
 
-  // are we currently pointing at an input?
-  if (index < it->aig->input_count) {
-    int rc = aig_get_input(it->aig, index, item);
-    ++it->index;
-    return rc;
+    struct aig_node n = { .type = AIG_AND_GATE, .and_gate.lhs = v };
+    if (type == AIG_INPUT) {
+      if ((rc = aig_get_input(aig, index, &n)))
+        return rc;
+    } else if (type == AIG_LATCH) {
+      if ((rc = aig_get_latch(aig, index, &n)))
+        return rc;
+    }
+
+    if ((rc = node_to_sat_define(&n, s)))
+      return rc;
   }
-  index -= it->aig->input_count;
 
-  // are we currently pointing at a latch?
-  if (index < it->aig->latch_count) {
-    int rc = aig_get_latch(it->aig, index, item);
-    ++it->index;
-    return rc;
+  return 0;
+}
+
+/** write constraints for every latch and AND gate
+ *
+ * \param aig AIG to translate
+ * \param s Output to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int write_constraints(aig_t *aig, sink_t *s) {
+
+  assert(aig != NULL);
+  assert(s != NULL);
+
+  int rc = 0;
+
+  for (uint64_t i = 0; i < aig->latch_count; i += BLOCK) {
+    uint64_t n = aig->latch_count - i < BLOCK ? aig->latch_count - i : BLOCK;
+    uint64_t current[BLOCK];
+    uint64_t next[BLOCK];
+    if ((rc = aig_get_latches(aig, i, n, current, next)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      struct aig_node node = { .type = AIG_LATCH,
+                               .latch = { .current = current[j] / 2,
+                                          .next = next[j] / 2,
+                                          .next_negated = next[j] % 2 } };
+      if ((rc = node_to_sat_constraint(&node, s)))
+        return rc;
+    }
   }
-  index -= it->aig->latch_count;
 
-  // if we have reached here, we must be up to an AND gate
-  assert(index < it->aig->and_count && "incorrect sat::next() logic");
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint64_t lhs[BLOCK];
+    uint64_t rhs0[BLOCK];
+    uint64_t rhs1[BLOCK];
+    if ((rc = aig_get_ands(aig, i, n, lhs, rhs0, rhs1)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      struct aig_node node = { .type = AIG_AND_GATE,
+                               .and_gate = { .lhs = lhs[j] / 2,
+                                             .rhs = { rhs0[j] / 2,
+                                                      rhs1[j] / 2 },
+                                             .negated = { rhs0[j] % 2,
+                                                          rhs1[j] % 2 } } };
+      if ((rc = node_to_sat_constraint(&node, s)))
+        return rc;
+    }
+  }
 
-  int rc = aig_get_and(it->aig, index, item);
-  ++it->index;
-  return rc;
+  return 0;
 }
 
+/** write constraints for the latches and AND gates in a cone
+ *
+ * \param aig AIG to translate
+ * \param cone Bitset of variables to emit
+ * \param s Output to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int write_cone_constraints(aig_t *aig, const uint64_t *cone,
+    sink_t *s) {
 
-// create an iterator for the nodes we need for SAT construction
-static int sat_iter(aig_t *aig, aig_node_iter_t **it) {
+  assert(aig != NULL);
+  assert(cone != NULL);
+  assert(s != NULL);
+
+  int rc = 0;
+
+  size_t words = (size_t)(aig->max_index / 64 + 1);
+  size_t word = 0;
+  uint64_t bits = cone[0] & ~UINT64_C(1); // skip the constant
+  uint64_t v;
+  while (next_in_cone(cone, words, &word, &bits, &v)) {
+
+    enum aig_node_type type;
+    uint64_t index;
+    rc = node_map_find(aig, v, &type, &index);
+    if (rc == ERANGE) // used but never defined
+      continue;
+    if (rc)
+      return rc;
+
+    struct aig_node n;
+    if (type == AIG_LATCH) {
+      if ((rc = aig_get_latch_no_symbol(aig, index, &n)))
+        return rc;
+    } else if (type == AIG_AND_GATE) {
+      if ((rc = aig_get_and(aig, index, &n)))
+        return rc;
+    } else {
+      continue;
+    }
+
+    if ((rc = node_to_sat_constraint(&n, s)))
+      return rc;
+  }
+
+  return 0;
+}
+
+/** write a SAT representation of some or all of an AIG to a file
+ *
+ * SMT-LIB requires every term to be declared before it is used, so this
+ * writes all declarations and then all constraints. Only the second of these
+ * passes decodes AND gate operands. A cone is written in variable order rather
+ * than file order, so only its own nodes need be fetched.
+ *
+ * \param aig AIG to translate
+ * \param cone Bitset of variables to emit, or NULL for all of them
+ * \param f Output file to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int to_sat_file(aig_t *aig, const uint64_t *cone, FILE *f) {
 
   assert(aig != NULL);
-  assert(it != NULL);
+  assert(f != NULL);
 
-  int rc = aig_iter(aig, it);
+  sink_t s;
+  int rc = sink_open(&s, f);
   if (rc)
     return rc;
 
-  // override the next determination to prevent iterating over outputs
-  (*it)->has_next = has_next;
-  (*it)->next = next;
+  if (cone == NULL) {
+    rc = write_defines(aig, &s);
+  } else {
+    rc = write_cone_defines(aig, cone, &s);
+  }
+  if (rc) {
+    (void)sink_close(&s);
+    return rc;
+  }
 
-  return 0;
+  if (cone == NULL) {
+    rc = write_constraints(aig, &s);
+  } else {
+    rc = write_cone_constraints(aig, cone, &s);
+  }
+  if (rc) {
+    (void)sink_close(&s);
+    return rc;
+  }
+
+  return sink_close(&s);
 }
 
 int aig_to_sat_file(aig_t *aig, FILE *f) {
@@ -306,115 +514,114 @@ int aig_to_sat_file(aig_t *aig, FILE *f) {
   if (f == NULL)
     return EINVAL;
 
-  int rc = 0;
-
-  // define each node
-  {
-    aig_node_iter_t *it = NULL;
-    if ((rc = sat_iter(aig, &it)))
-      return rc;
+  return to_sat_file(aig, NULL, f);
+}
 
-    while (aig_iter_has_next(it)) {
+int aig_to_sat_file_cone(aig_t *aig, const uint64_t *outputs, size_t count,
+    FILE *f) {
 
-      struct aig_node n;
-      if ((rc = aig_iter_next(it, &n))) {
-        aig_iter_free(&it);
-        return rc;
-      }
-
-      if ((rc = node_to_sat_define(&n, f))) {
-        aig_iter_free(&it);
-        return rc;
-      }
-    }
+  if (aig == NULL)
+    return EINVAL;
 
-    aig_iter_free(&it);
-  }
+  if (outputs == NULL && count > 0)
+    return EINVAL;
 
-  // emit constraints for each node
-  {
-    aig_node_iter_t *it = NULL;
-    if ((rc = sat_iter(aig, &it)))
-      return rc;
+  if (f == NULL)
+    return EINVAL;
 
-    while (aig_iter_has_next(it)) {
+  if (count > SIZE_MAX / sizeof(uint64_t))
+    return ENOMEM;
 
-      struct aig_node n;
-      if ((rc = aig_iter_next(it, &n))) {
-        aig_iter_free(&it);
-        return rc;
-      }
+  // find the literal each requested output refers to
+  uint64_t *literals = malloc((count == 0 ? 1 : count) * sizeof(literals[0]));
+  if (literals == NULL)
+    return ENOMEM;
 
-      if ((rc = node_to_sat_constraint(&n, f))) {
-        aig_iter_free(&it);
-        return rc;
-      }
+  int rc = 0;
+  for (size_t i = 0; i < count; i++) {
+    struct aig_node n;
+    if ((rc = aig_get_output_no_symbol(aig, outputs[i], &n))) {
+      free(literals);
+      return rc;
     }
-
-    aig_iter_free(&it);
+    literals[i] = n.output.variable_index * 2 + (n.output.negated ? 1 : 0);
   }
 
-  return 0;
-}
+  // latches are constrained to their next state, so follow them
+  uint64_t *cone = NULL;
+  rc = aig_cone(aig, literals, count, true, &cone);
+  free(literals);
+  if (rc)
+    return rc;
 
-int aig_node_to_sat_term(const struct aig_node *node, char **term) {
+  rc = to_sat_file(aig, cone, f);
+  free(cone);
 
-  if (node == NULL)
-    return EINVAL;
+  return rc;
+}
 
-  if (term == NULL)
-    return EINVAL;
+/** render a node to a newly allocated string
+ *
+ * \param node Node to render
+ * \param render Function to render it with
+ * \param out [out] The rendered string on success
+ * \returns 0 on success or an errno on failure
+ */
+static int node_to_string(const struct aig_node *node,
+    int (*render)(const struct aig_node *node, sink_t *s), char **out) {
+
+  assert(node != NULL);
+  assert(render != NULL);
+  assert(out != NULL);
 
   // create a buffer to write the SAT representation into
-  char *out = NULL;
-  size_t out_size = 0;
-  FILE *f = open_memstream(&out, &out_size);
+  char *buffer = NULL;
+  size_t buffer_size = 0;
+  FILE *f = open_memstream(&buffer, &buffer_size);
   if (f == NULL)
     return errno;
 
-  // delegate to the FILE interface
-  int rc = node_to_sat_term(node, f);
+  sink_t s;
+  int rc = sink_open(&s, f);
+  if (rc == 0) {
+    rc = render(node, &s);
+    int r = sink_close(&s);
+    if (rc == 0)
+      rc = r;
+  }
 
   // finalise the buffer
   fclose(f);
 
   if (rc) {
-    free(out);
+    free(buffer);
     return rc;
   }
 
-  *term = out;
+  *out = buffer;
   return 0;
 }
 
-int aig_node_to_sat_define(const struct aig_node *node, char **define) {
+int aig_node_to_sat_term(const struct aig_node *node, char **term) {
 
   if (node == NULL)
     return EINVAL;
 
-  if (define == NULL)
+  if (term == NULL)
     return EINVAL;
 
-  // create a buffer to write the SAT representation into
-  char *out = NULL;
-  size_t out_size = 0;
-  FILE *f = open_memstream(&out, &out_size);
-  if (f == NULL)
-    return errno;
+  return node_to_string(node, node_to_sat_term, term);
+}
 
-  // delegate to the FILE interface
-  int rc = node_to_sat_define(node, f);
+int aig_node_to_sat_define(const struct aig_node *node, char **define) {
 
-  // finalise the buffer
-  fclose(f);
+  if (node == NULL)
+    return EINVAL;
 
-  if (rc) {
-    free(out);
-    return rc;
-  }
+  if (define == NULL)
+    return EINVAL;
 
-  *define = out;
-  return 0;
+  return node_to_string(node, node_to_sat_define, define);
 }
 
 int aig_node_to_sat_constraint(const struct aig_node *node, char **constraint) {
@@ -425,24 +632,5 @@ int aig_node_to_sat_constraint(const struct aig_node *node, char **constraint) {
   if (constraint == NULL)
     return EINVAL;
 
-  // create a buffer to write the SAT representation into
-  char *out = NULL;
-  size_t out_size = 0;
-  FILE *f = open_memstream(&out, &out_size);
-  if (f == NULL)
-    return errno;
-
-  // delegate to the FILE interface
-  int rc = node_to_sat_constraint(node, f);
-
-  // finalise the buffer
-  fclose(f);
-
-  if (rc) {
-    free(out);
-    return rc;
-  }
-
-  *constraint = out;
-  return 0;
+  return node_to_string(node, node_to_sat_constraint, constraint);
 }
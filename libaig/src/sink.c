@@ -0,0 +1,52 @@
+#include <assert.h>
+#include <errno.h>
+#include "sink.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int sink_flush(sink_t *s) {
+
+  assert(s != NULL);
+  assert(s->file != NULL);
+
+  if (s->used == 0)
+    return 0;
+
+  size_t length = s->used;
+  s->used = 0;
+
+  // clear errno so a stale value is not mistaken for the cause of a failure
+  errno = 0;
+  if (fwrite(s->buffer, 1, length, s->file) != length)
+    return errno != 0 ? errno : EIO;
+
+  return 0;
+}
+
+int sink_open(sink_t *s, FILE *file) {
+
+  assert(s != NULL);
+  assert(file != NULL);
+
+  char *buffer = malloc(SINK_SIZE);
+  if (buffer == NULL)
+    return ENOMEM;
+
+  *s = (sink_t){ .file = file, .buffer = buffer };
+  return 0;
+}
+
+int sink_close(sink_t *s) {
+
+  assert(s != NULL);
+
+  int rc = 0;
+  if (s->buffer != NULL)
+    rc = sink_flush(s);
+
+  free(s->buffer);
+  *s = (sink_t){ 0 };
+
+  return rc;
+}
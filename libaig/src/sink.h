@@ -0,0 +1,120 @@
+// abstraction for the output textual translations are written to
+//
+// SAT and CNF output is many short tokens, mostly integers. Formatting each
+// through its own fprintf() call is dominated by libc overhead. Instead, text
+// is accumulated in a large private buffer, integers are converted by hand,
+// and full buffers are handed to fwrite() in one go.
+
+#pragma once
+
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/// size of the buffer a sink accumulates text in
+enum { SINK_SIZE = 1 << 16 };
+
+/// Output to write to.
+typedef struct {
+
+  /// File handle to eventually write to.
+  FILE *file;
+
+  /// Buffered text not yet written.
+  char *buffer;
+  size_t used;
+
+} sink_t;
+
+/** write out everything buffered in a sink
+ *
+ * \param s Sink to operate on
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int sink_flush(sink_t *s);
+
+/** append text to a sink
+ *
+ * \param s Sink to write to
+ * \param text Text to write
+ * \param length Number of bytes in text
+ * \returns 0 on success or an errno on failure
+ */
+static inline int sink_write(sink_t *s, const char *text, size_t length) {
+  assert(s != NULL);
+  assert(s->buffer != NULL);
+  assert(text != NULL || length == 0);
+
+  if (SINK_SIZE - s->used < length) {
+    int rc = sink_flush(s);
+    if (rc)
+      return rc;
+
+    // anything too large to buffer goes straight to the file
+    if (length > SINK_SIZE) {
+      // as in sink_flush(), so errno only reflects this write
+      errno = 0;
+      if (fwrite(text, 1, length, s->file) != length)
+        return errno != 0 ? errno : EIO;
+      return 0;
+    }
+  }
+
+  memcpy(&s->buffer[s->used], text, length);
+  s->used += length;
+  return 0;
+}
+
+/** append a NUL terminated string to a sink
+ *
+ * \param s Sink to write to
+ * \param text String to write
+ * \returns 0 on success or an errno on failure
+ */
+static inline int sink_puts(sink_t *s, const char *text) {
+  assert(text != NULL);
+  return sink_write(s, text, strlen(text));
+}
+
+/** append an unsigned integer in decimal to a sink
+ *
+ * \param s Sink to write to
+ * \param value Number to write
+ * \returns 0 on success or an errno on failure
+ */
+static inline int sink_uint(sink_t *s, uint64_t value) {
+  assert(s != NULL);
+
+  // generate digits backwards, from the end of a scratch buffer
+  char digits[20];
+  size_t i = sizeof(digits);
+  do {
+    digits[--i] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  return sink_write(s, &digits[i], sizeof(digits) - i);
+}
+
+/** open a sink that writes to a file
+ *
+ * \param s [out] Sink to initialise
+ * \param file File to eventually write to
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int sink_open(sink_t *s, FILE *file);
+
+/** write out anything buffered in a sink and release its resources
+ *
+ * The underlying file is not closed.
+ *
+ * \param s Sink to operate on
+ * \returns 0 on success or an errno if writing failed
+ */
+__attribute__((visibility("internal")))
+int sink_close(sink_t *s);
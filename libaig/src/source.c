@@ -0,0 +1,125 @@
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "source.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int source_error(const source_t *s) {
+  assert(s != NULL);
+
+  // reading from memory cannot fail other than by reaching the end
+  if (s->file == NULL)
+    return 0;
+
+  return ferror(s->file) ? EIO : 0;
+}
+
+bool source_remaining(const source_t *s, size_t *remaining) {
+  assert(s != NULL);
+  assert(remaining != NULL);
+
+  if (s->file == NULL) {
+    assert(s->offset <= s->size);
+    *remaining = s->size - s->offset;
+    return true;
+  }
+
+  struct stat st;
+  if (fstat(fileno(s->file), &st) < 0 || !S_ISREG(st.st_mode))
+    return false;
+
+  off_t offset = ftello(s->file);
+  if (offset < 0 || offset > st.st_size)
+    return false;
+
+  if ((uintmax_t)(st.st_size - offset) > SIZE_MAX) {
+    *remaining = SIZE_MAX;
+  } else {
+    *remaining = (size_t)(st.st_size - offset);
+  }
+  return true;
+}
+
+int source_map(source_t *s, const char *filename) {
+  assert(s != NULL);
+  assert(filename != NULL);
+
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return errno;
+
+  int rc = 0;
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    rc = errno;
+    goto done;
+  }
+
+  // if this is not a regular file, we cannot map it so read it through stdio
+  if (!S_ISREG(st.st_mode)) {
+    FILE *f = fdopen(fd, "r");
+    if (f == NULL) {
+      rc = errno;
+      goto done;
+    }
+    memset(s, 0, sizeof(*s));
+    s->file = f;
+    return 0;
+  }
+
+  // can we address the entire file?
+  if ((uintmax_t)st.st_size > SIZE_MAX) {
+    rc = EFBIG;
+    goto done;
+  }
+  size_t size = (size_t)st.st_size;
+
+  memset(s, 0, sizeof(*s));
+
+  // an empty file cannot be mapped, but it is also trivial to read
+  if (size == 0) {
+    s->base = "";
+    goto done;
+  }
+
+  void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (base == MAP_FAILED) {
+    rc = errno;
+    goto done;
+  }
+
+  // we read the file front to back, so let the OS know it can read ahead
+  // aggressively; ignore failure as this is only a hint
+  (void)madvise(base, size, MADV_SEQUENTIAL);
+
+  s->base = base;
+  s->size = size;
+  s->mapped = true;
+
+done:
+  // the mapping (if we made one) remains valid after the descriptor is closed
+  (void)close(fd);
+
+  return rc;
+}
+
+void source_close(source_t *s) {
+
+  if (s == NULL)
+    return;
+
+  if (s->file != NULL)
+    (void)fclose(s->file);
+
+  if (s->mapped)
+    (void)munmap((void*)s->base, s->size);
+
+  memset(s, 0, sizeof(*s));
+}
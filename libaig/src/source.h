@@ -0,0 +1,123 @@
+// abstraction for the input an AIG is parsed from
+//
+// The parser reads one byte at a time with occasional single byte lookahead.
+// When reading through stdio, every byte costs a libc call. When the input is
+// available in memory (e.g. a memory-mapped file), reading is a pointer bump.
+// Lazy parsing retains its position as part of this structure, so it works the
+// same way against either kind of source.
+
+#pragma once
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/// Input to parse from. A zeroed out structure is considered to be a closed
+/// source.
+typedef struct {
+
+  /// File handle, if reading through stdio.
+  FILE *file;
+
+  /// In-memory contents, if reading from a buffer.
+  const char *base;
+  size_t size;
+
+  /// Read position within base.
+  size_t offset;
+
+  /// Was base created by mmap() and needs to be unmapped on close?
+  bool mapped;
+
+} source_t;
+
+/** is this source open and able to be read from?
+ *
+ * \param s Source to examine
+ * \returns True if the source is open
+ */
+static inline bool source_is_open(const source_t *s) {
+  assert(s != NULL);
+  return s->file != NULL || s->base != NULL;
+}
+
+/** read the next byte from a source
+ *
+ * \param s Source to read from
+ * \returns The byte read as an unsigned char or EOF
+ */
+static inline int source_getc(source_t *s) {
+  assert(s != NULL);
+
+  if (s->file != NULL)
+    return getc(s->file);
+
+  if (s->offset >= s->size)
+    return EOF;
+
+  return (unsigned char)s->base[s->offset++];
+}
+
+/** return the last byte read back to a source
+ *
+ * Only a single byte of push back is supported, and it must be the byte that
+ * was last read.
+ *
+ * \param s Source to operate on
+ * \param c The byte that was last read
+ */
+static inline void source_ungetc(source_t *s, int c) {
+  assert(s != NULL);
+
+  if (s->file != NULL) {
+    (void)ungetc(c, s->file);
+    return;
+  }
+
+  assert(s->offset > 0 && "push back on a source with nothing read");
+  assert((unsigned char)s->base[s->offset - 1] == (unsigned char)c &&
+    "push back of a byte that was not the last read");
+  --s->offset;
+}
+
+/** find how many bytes remain to be read from a source, if this is known
+ *
+ * This is known for in-memory sources and for stdio sources backed by a
+ * regular file, but not for pipes or other streams.
+ *
+ * \param s Source to examine
+ * \param remaining [out] Number of bytes not yet read on success
+ * \returns True if the number of remaining bytes is known
+ */
+__attribute__((visibility("internal")))
+bool source_remaining(const source_t *s, size_t *remaining);
+
+/** get the error, if any, that occurred during the last read of a source
+ *
+ * \param s Source to examine
+ * \returns An errno if an error occurred or 0 otherwise
+ */
+__attribute__((visibility("internal")))
+int source_error(const source_t *s);
+
+/** open a source that reads from a memory-mapped file
+ *
+ * If the file is not something that can be mapped, like a pipe, this falls
+ * back to opening it for reading through stdio.
+ *
+ * \param s [out] Source to initialise
+ * \param filename Path to the file to open
+ * \returns 0 on success or an errno on failure
+ */
+__attribute__((visibility("internal")))
+int source_map(source_t *s, const char *filename);
+
+/** release all resources associated with a source
+ *
+ * After calling this, the source will be closed and can be reused if desired.
+ *
+ * \param s Source to operate on
+ */
+__attribute__((visibility("internal")))
+void source_close(source_t *s);
@@ -0,0 +1,295 @@
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <assert.h>
+#include <errno.h>
+#include "node_map.h"
+#include "parse.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "topo.h"
+
+/// number of AND gates to decode at once
+enum { BLOCK = 256 };
+
+/// search state of an AND gate
+enum { UNVISITED, ON_STACK, ORDERED };
+
+/** are the AND gates of an AIG already in topological order?
+ *
+ * This is true when every gate sits at its inferred position and uses only
+ * variables below its own. Anything a gate uses is then an input, a latch, or
+ * an earlier gate.
+ *
+ * \param aig AIG to examine
+ * \param ordered [out] Whether the gates are in order on success
+ * \returns 0 on success or an errno on failure
+ */
+static int in_order(aig_t *aig, bool *ordered) {
+
+  assert(aig != NULL);
+  assert(ordered != NULL);
+
+  int rc = parse_ands(aig, UINT64_MAX);
+  if (rc)
+    return rc;
+
+  // any gate away from its inferred position rules out the cheap check
+  if (aig->and_lhs.count > 0) {
+    *ordered = false;
+    return 0;
+  }
+
+  for (uint64_t i = 0; i < aig->and_count; i += BLOCK) {
+    uint64_t n = aig->and_count - i < BLOCK ? aig->and_count - i : BLOCK;
+    uint64_t lhs[BLOCK];
+    uint64_t rhs0[BLOCK];
+    uint64_t rhs1[BLOCK];
+    if ((rc = aig_get_ands(aig, i, n, lhs, rhs0, rhs1)))
+      return rc;
+
+    for (uint64_t j = 0; j < n; j++) {
+      if (rhs0[j] / 2 >= lhs[j] / 2 || rhs1[j] / 2 >= lhs[j] / 2) {
+        *ordered = false;
+        return 0;
+      }
+    }
+  }
+
+  *ordered = true;
+  return 0;
+}
+
+/** find the AND gate that defines a variable
+ *
+ * \param aig AIG to search
+ * \param variable_index Variable to lookup
+ * \param found [out] Whether an AND gate defines this variable on success
+ * \param index [out] Index of the defining AND gate, if found
+ * \returns 0 on success or an errno on failure
+ */
+static int find_gate(aig_t *aig, uint64_t variable_index, bool *found,
+    uint64_t *index) {
+
+  assert(aig != NULL);
+  assert(found != NULL);
+  assert(index != NULL);
+
+  *found = false;
+
+  // the constant is not defined by any node
+  if (variable_index == 0)
+    return 0;
+
+  enum aig_node_type type;
+  int rc = node_map_find(aig, variable_index, &type, index);
+
+  // a variable that nothing defines is treated as an input
+  if (rc == ERANGE)
+    return 0;
+  if (rc)
+    return rc;
+
+  *found = type == AIG_AND_GATE;
+  return 0;
+}
+
+/// a stack of AND gates being ordered
+typedef struct {
+  uint64_t *items;
+  size_t size;
+  size_t capacity;
+} worklist_t;
+
+static int push(worklist_t *s, uint64_t index) {
+
+  assert(s != NULL);
+
+  if (s->size == s->capacity) {
+    size_t c = s->capacity == 0 ? 64 : s->capacity * 2;
+    if (c < s->capacity || SIZE_MAX / sizeof(s->items[0]) < c)
+      return ENOMEM;
+    uint64_t *i = realloc(s->items, c * sizeof(i[0]));
+    if (i == NULL)
+      return ENOMEM;
+    s->items = i;
+    s->capacity = c;
+  }
+
+  s->items[s->size++] = index;
+  return 0;
+}
+
+/** append an AND gate and every gate it depends on to a topological order
+ *
+ * This is a depth first search with an explicit stack, so it is not limited
+ * by the depth of the AIG. Each gate is visited twice: once to push the gates
+ * it uses, and once after they are all ordered to append itself.
+ *
+ * \param aig AIG to read from
+ * \param states Search state of every AND gate
+ * \param stack Scratch space for the search
+ * \param root AND gate to start from
+ * \param order Order to append to
+ * \param size [in,out] Number of gates in order
+ * \returns 0 on success, ELOOP if a cycle is found, or another errno on failure
+ */
+static int visit(aig_t *aig, uint8_t *states, worklist_t *stack,
+    uint64_t root, uint64_t *order, uint64_t *size) {
+
+  assert(aig != NULL);
+  assert(states != NULL);
+  assert(stack != NULL);
+  assert(stack->size == 0);
+  assert(order != NULL);
+  assert(size != NULL);
+
+  int rc = push(stack, root);
+  if (rc)
+    return rc;
+
+  while (stack->size > 0) {
+    uint64_t index = stack->items[stack->size - 1];
+
+    // were we pushed more than once and already ordered?
+    if (states[index] == ORDERED) {
+      --stack->size;
+      continue;
+    }
+
+    // are we returning to this gate with all of its operands ordered?
+    if (states[index] == ON_STACK) {
+      states[index] = ORDERED;
+      order[(*size)++] = index;
+      --stack->size;
+      continue;
+    }
+
+    // otherwise, this is our first visit so queue any operands yet to be
+    // ordered
+    struct aig_node n;
+    if ((rc = aig_get_and(aig, index, &n)))
+      return rc;
+
+    states[index] = ON_STACK;
+    for (size_t i = 0; i < sizeof(n.and_gate.rhs) / sizeof(n.and_gate.rhs[0]);
+         i++) {
+      bool found;
+      uint64_t operand;
+      if ((rc = find_gate(aig, n.and_gate.rhs[i], &found, &operand)))
+        return rc;
+      if (!found)
+        continue;
+      if (states[operand] == ON_STACK)
+        return ELOOP;
+      if (states[operand] == UNVISITED) {
+        if ((rc = push(stack, operand)))
+          return rc;
+      }
+    }
+  }
+
+  return 0;
+}
+
+int topo_sort(aig_t *aig) {
+
+  assert(aig != NULL);
+
+  if (aig->topo_sorted)
+    return 0;
+
+  bool ordered;
+  int rc = in_order(aig, &ordered);
+  if (rc)
+    return rc;
+
+  // if the file order will do, there is nothing to store
+  if (ordered) {
+    aig->topo_sorted = 1;
+    return 0;
+  }
+
+  if (aig->and_count > SIZE_MAX / sizeof(uint64_t))
+    return ENOMEM;
+
+  uint8_t *states = calloc(aig->and_count, sizeof(states[0]));
+  uint64_t *order = malloc(aig->and_count * sizeof(order[0]));
+  worklist_t stack = {0};
+  if (states == NULL || order == NULL) {
+    rc = ENOMEM;
+    goto done;
+  }
+
+  // visit gates in file order, so gates already in sequence stay that way
+  uint64_t size = 0;
+  for (uint64_t i = 0; i < aig->and_count; i++) {
+    if (states[i] != UNVISITED)
+      continue;
+    if ((rc = visit(aig, states, &stack, i, order, &size)))
+      goto done;
+  }
+  assert(size == aig->and_count);
+
+  aig->topo_order = order;
+  order = NULL;
+  aig->topo_sorted = 1;
+
+done:
+  free(stack.items);
+  free(order);
+  free(states);
+
+  return rc;
+}
+
+int topo_sort_subset(aig_t *aig, const uint64_t *variables, uint64_t **order,
+    uint64_t *count) {
+
+  assert(aig != NULL);
+  assert(variables != NULL);
+  assert(order != NULL);
+  assert(count != NULL);
+
+  if (aig->and_count > SIZE_MAX / sizeof(uint64_t))
+    return ENOMEM;
+
+  uint8_t *states = calloc(aig->and_count, sizeof(states[0]));
+  uint64_t *o = malloc((aig->and_count == 0 ? 1 : aig->and_count)
+                       * sizeof(o[0]));
+  worklist_t stack = {0};
+  int rc = 0;
+  if (states == NULL || o == NULL) {
+    rc = ENOMEM;
+    goto done;
+  }
+
+  // start from the defining gate of each variable, in variable order
+  uint64_t size = 0;
+  for (uint64_t v = 1; v <= aig->max_index; v++) {
+    if (!((variables[v / 64] >> (v % 64)) & 1))
+      continue;
+
+    bool found;
+    uint64_t index;
+    if ((rc = find_gate(aig, v, &found, &index)))
+      goto done;
+    if (!found || states[index] != UNVISITED)
+      continue;
+
+    if ((rc = visit(aig, states, &stack, index, o, &size)))
+      goto done;
+  }
+
+  *order = o;
+  o = NULL;
+  *count = size;
+
+done:
+  free(stack.items);
+  free(o);
+  free(states);
+
+  return rc;
+}
@@ -0,0 +1,56 @@
+// abstraction for ordering AND gates so each follows the gates it uses
+//
+// The binary format stores AND gates in topological order, and most ASCII
+// files do too. So when every gate’s operands are already defined by earlier
+// nodes we record only that fact and store no order at all. Otherwise, a
+// depth first search over the gates computes an order that is cached within
+// the AIG. Latches are treated as inputs here, so sequential feedback through
+// a latch is not a cycle.
+
+#pragma once
+
+#include <aig/aig.h>
+#include "aig_t.h"
+#include <stdint.h>
+
+/** compute a topological order of the AND gates in an AIG
+ *
+ * This parses every AND gate if they have not already been parsed. On success,
+ * aig->topo_order is either NULL, meaning the gates are already in topological
+ * order, or a list of every AND gate index in topological order. Calling this
+ * on an AIG whose order is already computed is a no-op.
+ *
+ * \param aig AIG to operate on
+ * \returns 0 on success, ELOOP if the AND gates contain a combinational cycle,
+ *   or another errno on failure
+ */
+__attribute__((visibility("internal")))
+int topo_sort(aig_t *aig);
+
+/** compute a topological order of the AND gates defining a set of variables
+ *
+ * Unlike topo_sort(), this only visits the gates defining the given variables
+ * and the gates they depend on, so a cycle elsewhere in the AIG does not
+ * prevent ordering. The order is not cached.
+ *
+ * \param aig AIG to operate on
+ * \param variables Bitset of variables whose defining gates to order
+ * \param order [out] Indices of the ordered AND gates on success. The caller
+ *   is responsible for freeing this.
+ * \param count [out] Number of entries in order on success
+ * \returns 0 on success, ELOOP if these gates contain a cycle, or another
+ *   errno on failure
+ */
+__attribute__((visibility("internal")))
+int topo_sort_subset(aig_t *aig, const uint64_t *variables, uint64_t **order,
+  uint64_t *count);
+
+/** get the AND gate at a given point in topological order
+ *
+ * \param aig AIG whose order has been computed by topo_sort()
+ * \param index Position within the topological order
+ * \returns Index of the AND gate at this position
+ */
+static inline uint64_t topo_gate(const aig_t *aig, uint64_t index) {
+  return aig->topo_order == NULL ? index : aig->topo_order[index];
+}
@@ -0,0 +1,185 @@
+// check the level iterator and per-level slices of AND gates
+//
+// Every AND gate should appear in exactly one slice, that of one more than the
+// deepest of its operands, with the slices in increasing index order. The
+// level iterator should yield the same gates in the same order as the slices
+// laid end to end.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** compare two AND gates
+ *
+ * \param a First gate
+ * \param b Second gate
+ * \returns True if they are the same
+ */
+static bool and_eq(const struct aig_node *a, const struct aig_node *b) {
+  return a->type == AIG_AND_GATE && b->type == AIG_AND_GATE
+      && a->and_gate.lhs == b->and_gate.lhs
+      && a->and_gate.rhs[0] == b->and_gate.rhs[0]
+      && a->and_gate.rhs[1] == b->and_gate.rhs[1]
+      && a->and_gate.negated[0] == b->and_gate.negated[0]
+      && a->and_gate.negated[1] == b->and_gate.negated[1];
+}
+
+/** check the slices and level iterator of an AIG
+ *
+ * \param aig AIG to examine
+ * \returns True if they were as expected
+ */
+static bool check(aig_t *aig) {
+
+  const uint32_t *levels = NULL;
+  size_t count = 0;
+  int rc = aig_levels(aig, &levels);
+  if (rc == 0)
+    rc = aig_level_count(aig, &count);
+  if (rc) {
+    fprintf(stderr, "%s\n", strerror(rc));
+    return false;
+  }
+
+  uint64_t ands = aig_and_count(aig);
+  bool *seen = calloc(ands + 1, sizeof(seen[0]));
+  if (seen == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return false;
+  }
+
+  aig_node_iter_t *it = NULL;
+  if ((rc = aig_iter_level(aig, &it))) {
+    fprintf(stderr, "aig_iter_level: %s\n", strerror(rc));
+    free(seen);
+    return false;
+  }
+
+  bool ok = true;
+  uint64_t total = 0;
+  size_t deepest = 0;
+
+  for (size_t level = 0; ok && level < count; level++) {
+
+    const uint64_t *gates = NULL;
+    size_t n = 0;
+    if ((rc = aig_level_gates(aig, level, &gates, &n))) {
+      fprintf(stderr, "aig_level_gates(%zu): %s\n", level, strerror(rc));
+      ok = false;
+      break;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+
+      if (gates[i] >= ands || seen[gates[i]]
+          || (i > 0 && gates[i] <= gates[i - 1])) {
+        fprintf(stderr, "level %zu: gate %" PRIu64 " out of order or repeated\n",
+                level, gates[i]);
+        ok = false;
+        break;
+      }
+      seen[gates[i]] = true;
+      ++total;
+
+      struct aig_node gate;
+      if ((rc = aig_get_and(aig, gates[i], &gate))) {
+        fprintf(stderr, "aig_get_and(%" PRIu64 "): %s\n", gates[i],
+                strerror(rc));
+        ok = false;
+        break;
+      }
+
+      uint32_t l0 = levels[gate.and_gate.rhs[0]];
+      uint32_t l1 = levels[gate.and_gate.rhs[1]];
+      size_t expected = (size_t)(l0 > l1 ? l0 : l1) + 1;
+      if (level != expected) {
+        fprintf(stderr, "gate %" PRIu64 " is at level %zu, expected %zu\n",
+                gates[i], level, expected);
+        ok = false;
+        break;
+      }
+      if (level > deepest)
+        deepest = level;
+
+      // the iterator should yield the same gate
+      struct aig_node yielded;
+      if (!aig_iter_has_next(it)) {
+        fprintf(stderr, "level iterator ended early\n");
+        ok = false;
+        break;
+      }
+      if ((rc = aig_iter_next(it, &yielded)) || !and_eq(&yielded, &gate)) {
+        fprintf(stderr, "level iterator yielded a gate other than %" PRIu64
+                "\n", gates[i]);
+        ok = false;
+        break;
+      }
+    }
+  }
+
+  if (ok && total != ands) {
+    fprintf(stderr, "slices hold %" PRIu64 " of %" PRIu64 " gates\n", total,
+            ands);
+    ok = false;
+  }
+
+  if (ok && aig_iter_has_next(it)) {
+    fprintf(stderr, "level iterator yielded more gates than the slices\n");
+    ok = false;
+  }
+
+  if (ok && count != deepest + 1) {
+    fprintf(stderr, "%zu levels, expected %zu\n", count, deepest + 1);
+    ok = false;
+  }
+
+  const uint64_t *gates = NULL;
+  size_t n = 0;
+  if (ok && aig_level_gates(aig, count, &gates, &n) != ERANGE) {
+    fprintf(stderr, "level beyond the last was not rejected\n");
+    ok = false;
+  }
+
+  aig_iter_free(&it);
+  free(seen);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s filename...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+    for (int eager = 0; eager < 2; eager++) {
+      struct aig_options options = { .eager = eager };
+
+      aig_t *aig = NULL;
+      int rc = aig_load(&aig, argv[i], options);
+      if (rc) {
+        fprintf(stderr, "aig_load(%s): %s\n", argv[i], strerror(rc));
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      if (!check(aig)) {
+        fprintf(stderr, "%s failed with eager = %d\n", argv[i], eager);
+        result = EXIT_FAILURE;
+      }
+
+      aig_free(&aig);
+    }
+  }
+
+  return result;
+}
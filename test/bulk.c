@@ -0,0 +1,258 @@
+// check that the bulk getters agree with retrieving nodes one at a time
+//
+// Each file is loaded with the options given on the command line. Windows of
+// every position and a range of lengths are compared, so ranges that start and
+// end at every alignment within the packed storage are covered.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// longest window to compare at each position
+enum { WINDOW_MAX = 70 };
+
+/// expected values of a kind of node, retrieved one at a time
+typedef struct {
+  uint64_t count;
+  uint64_t *values[3];
+} expected_t;
+
+/** compare the result of a bulk getter against expected values
+ *
+ * \param what Description of the values for error messages
+ * \param first Index of the first value retrieved
+ * \param count Number of values retrieved
+ * \param got Values retrieved
+ * \param expected Expected values, indexed from 0
+ * \returns True if they match
+ */
+static bool check(const char *what, uint64_t first, uint64_t count,
+    const uint64_t *got, const uint64_t *expected) {
+
+  for (uint64_t i = 0; i < count; i++) {
+    if (got[i] != expected[first + i]) {
+      fprintf(stderr, "%s %" PRIu64 " from [%" PRIu64 ", %" PRIu64 "): got %"
+              PRIu64 ", expected %" PRIu64 "\n", what, first + i, first,
+              first + count, got[i], expected[first + i]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/** retrieve a window of values with a bulk getter
+ *
+ * \param aig AIG to read from
+ * \param kind 0 – 3 for inputs, latches, outputs, or AND gates
+ * \param first Index of the first value to retrieve
+ * \param count Number of values to retrieve
+ * \param out [out] Up to three arrays to write into, any of which may be NULL
+ *   where the getter allows
+ * \returns The getter’s return value
+ */
+static int get(aig_t *aig, int kind, uint64_t first, uint64_t count,
+    uint64_t **out) {
+
+  switch (kind) {
+    case 0: return aig_get_inputs(aig, first, count, out[0]);
+    case 1: return aig_get_latches(aig, first, count, out[0], out[1]);
+    case 2: return aig_get_outputs(aig, first, count, out[0]);
+    default: return aig_get_ands(aig, first, count, out[0], out[1], out[2]);
+  }
+}
+
+static const char *KIND_NAMES[] = { "input", "latch", "output", "AND gate" };
+static const size_t KIND_ARRAYS[] = { 1, 2, 1, 3 };
+
+/** compare every window of a kind of node
+ *
+ * \param aig AIG to read from
+ * \param kind 0 – 3 for inputs, latches, outputs, or AND gates
+ * \param expected Values retrieved one at a time
+ * \returns True if they match
+ */
+static bool compare(aig_t *aig, int kind, const expected_t *expected) {
+
+  uint64_t buffers[3][WINDOW_MAX];
+  uint64_t n = expected->count;
+
+  for (uint64_t first = 0; first <= n; first++) {
+    for (uint64_t count = 0; count <= WINDOW_MAX && count <= n - first;
+         count++) {
+
+      // ask for each array alone, and then all of them together
+      for (size_t only = 0; only <= KIND_ARRAYS[kind]; only++) {
+        uint64_t *out[3] = { NULL, NULL, NULL };
+        for (size_t j = 0; j < KIND_ARRAYS[kind]; j++) {
+          if (only == KIND_ARRAYS[kind] || only == j)
+            out[j] = buffers[j];
+        }
+
+        // inputs and outputs have no optional arrays
+        if (KIND_ARRAYS[kind] == 1 && only == 0)
+          continue;
+
+        int rc = get(aig, kind, first, count, out);
+        if (rc) {
+          fprintf(stderr, "%s [%" PRIu64 ", %" PRIu64 "): %s\n",
+                  KIND_NAMES[kind], first, first + count, strerror(rc));
+          return false;
+        }
+        for (size_t j = 0; j < KIND_ARRAYS[kind]; j++) {
+          if (out[j] != NULL && !check(KIND_NAMES[kind], first, count, out[j],
+              expected->values[j]))
+            return false;
+        }
+      }
+    }
+  }
+
+  // ranges beyond the end should be rejected
+  uint64_t *out[3] = { buffers[0], buffers[1], buffers[2] };
+  if (get(aig, kind, n, 1, out) != ERANGE
+      || get(aig, kind, n + 1, 0, out) != ERANGE
+      || get(aig, kind, 1, UINT64_MAX, out) != ERANGE) {
+    fprintf(stderr, "%s: out of range request was not rejected\n",
+            KIND_NAMES[kind]);
+    return false;
+  }
+
+  return true;
+}
+
+/** retrieve every node of each kind one at a time
+ *
+ * \param aig AIG to read from
+ * \param expected [out] Values of each kind of node, to be freed by the caller
+ * \returns 0 on success or an errno on failure
+ */
+static int retrieve(aig_t *aig, expected_t expected[4]) {
+
+  expected[0].count = aig_input_count(aig);
+  expected[1].count = aig_latch_count(aig);
+  expected[2].count = aig_output_count(aig);
+  expected[3].count = aig_and_count(aig);
+
+  for (int kind = 0; kind < 4; kind++) {
+    for (size_t j = 0; j < KIND_ARRAYS[kind]; j++) {
+      expected[kind].values[j] = calloc(expected[kind].count + 1,
+                                        sizeof(uint64_t));
+      if (expected[kind].values[j] == NULL)
+        return ENOMEM;
+    }
+  }
+
+  for (int kind = 0; kind < 4; kind++) {
+    uint64_t **v = expected[kind].values;
+    for (uint64_t i = 0; i < expected[kind].count; i++) {
+      struct aig_node n;
+      int rc = 0;
+      switch (kind) {
+        case 0:
+          if ((rc = aig_get_input_no_symbol(aig, i, &n)))
+            return rc;
+          v[0][i] = n.input.variable_index * 2;
+          break;
+        case 1:
+          if ((rc = aig_get_latch_no_symbol(aig, i, &n)))
+            return rc;
+          v[0][i] = n.latch.current * 2;
+          v[1][i] = n.latch.next * 2 + n.latch.next_negated;
+          break;
+        case 2:
+          if ((rc = aig_get_output_no_symbol(aig, i, &n)))
+            return rc;
+          v[0][i] = n.output.variable_index * 2 + n.output.negated;
+          break;
+        default:
+          if ((rc = aig_get_and(aig, i, &n)))
+            return rc;
+          v[0][i] = n.and_gate.lhs * 2;
+          v[1][i] = n.and_gate.rhs[0] * 2 + n.and_gate.negated[0];
+          v[2][i] = n.and_gate.rhs[1] * 2 + n.and_gate.negated[1];
+          break;
+      }
+    }
+  }
+
+  return 0;
+}
+
+int main(int argc, char **argv) {
+
+  const char *argv0 = argv[0];
+
+  struct aig_options options = { 0 };
+  for (; argc > 1 && strncmp(argv[1], "--", 2) == 0; --argc, ++argv) {
+    if (strcmp(argv[1], "--eager") == 0) {
+      options.eager = true;
+    } else if (strcmp(argv[1], "--compress") == 0) {
+      options.compress = true;
+    } else {
+      fprintf(stderr, "unknown option %s\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s [--eager] [--compress] filename...\n", argv0);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+
+    expected_t expected[4] = { { 0 } };
+    aig_t *aig = NULL;
+    bool ok = false;
+
+    int rc = aig_load(&aig, argv[i], options);
+    if (rc) {
+      fprintf(stderr, "aig_load(%s): %s\n", argv[i], strerror(rc));
+      goto next;
+    }
+
+    // start with a bulk read from the middle of the AND gates, so it is this
+    // that has to parse up to there in lazy mode
+    uint64_t n = aig_and_count(aig);
+    uint64_t rhs1[WINDOW_MAX];
+    uint64_t count = n / 2 < WINDOW_MAX ? n / 2 : WINDOW_MAX;
+    if ((rc = aig_get_ands(aig, n / 2, count, NULL, NULL, rhs1))) {
+      fprintf(stderr, "%s: aig_get_ands: %s\n", argv[i], strerror(rc));
+      goto next;
+    }
+
+    if ((rc = retrieve(aig, expected))) {
+      fprintf(stderr, "%s: %s\n", argv[i], strerror(rc));
+      goto next;
+    }
+
+    if (!check("AND gate", n / 2, count, rhs1, expected[3].values[2]))
+      goto next;
+
+    ok = true;
+    for (int kind = 0; kind < 4; kind++)
+      ok &= compare(aig, kind, &expected[kind]);
+
+  next:
+    if (!ok) {
+      fprintf(stderr, "%s failed\n", argv[i]);
+      result = EXIT_FAILURE;
+    }
+    for (int kind = 0; kind < 4; kind++) {
+      for (size_t j = 0; j < 3; j++)
+        free(expected[kind].values[j]);
+    }
+    if (aig != NULL)
+      aig_free(&aig);
+  }
+
+  return result;
+}
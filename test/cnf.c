@@ -0,0 +1,228 @@
+// check the DIMACS CNF generated for small AIGs
+//
+// Beyond the header, the CNF is checked semantically by enumerating every
+// assignment to its variables. An assignment must satisfy the CNF if and only
+// if it is consistent with the AIG: each AND gate equals the conjunction of its
+// operands, each latch equals its next state, and the constant is false.
+
+#include <aig/aig.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// the largest number of variables we are willing to enumerate
+enum { VARIABLES_MAX = 20 };
+
+/// value of an AIGER literal under an assignment, indexed by variable
+static bool literal(const bool *assignment, uint64_t lit) {
+  return assignment[lit / 2] != (lit % 2 == 1);
+}
+
+/** is an assignment consistent with an AIG?
+ *
+ * \param aig AIG to evaluate
+ * \param assignment Value of each variable, with the constant at index 0
+ * \returns True if the assignment is consistent
+ */
+static bool consistent(aig_t *aig, const bool *assignment) {
+
+  if (assignment[0])
+    return false;
+
+  for (uint64_t i = 0; i < aig_latch_count(aig); i++) {
+    uint64_t current, next;
+    (void)aig_get_latches(aig, i, 1, &current, &next);
+    if (literal(assignment, current) != literal(assignment, next))
+      return false;
+  }
+
+  for (uint64_t i = 0; i < aig_and_count(aig); i++) {
+    uint64_t lhs, rhs0, rhs1;
+    (void)aig_get_ands(aig, i, 1, &lhs, &rhs0, &rhs1);
+    bool conjunction = literal(assignment, rhs0) && literal(assignment, rhs1);
+    if (literal(assignment, lhs) != conjunction)
+      return false;
+  }
+
+  return true;
+}
+
+/** does an assignment satisfy a CNF?
+ *
+ * \param cnf Clauses as a sequence of DIMACS literals, each clause ending in 0
+ * \param length Number of entries in cnf
+ * \param assignment Value of each DIMACS variable
+ * \returns True if every clause is satisfied
+ */
+static bool satisfies(const long *cnf, size_t length, const bool *assignment) {
+
+  bool clause = false;
+  for (size_t i = 0; i < length; i++) {
+    if (cnf[i] == 0) {
+      if (!clause)
+        return false;
+      clause = false;
+    } else if (cnf[i] > 0) {
+      clause |= assignment[cnf[i]];
+    } else {
+      clause |= !assignment[-cnf[i]];
+    }
+  }
+
+  return true;
+}
+
+/** parse the clauses of a DIMACS CNF
+ *
+ * \param text CNF text after the header
+ * \param variables Number of variables the header declares
+ * \param cnf [out] Literals of each clause, each clause ending in 0
+ * \param length [out] Number of entries in cnf
+ * \param clauses [out] Number of clauses read
+ * \returns True if every clause was well formed and in range
+ */
+static bool parse(const char *text, unsigned long variables, long *cnf,
+    size_t *length, unsigned long *clauses) {
+
+  size_t n = 0;
+  unsigned long seen = 0;
+  for (const char *p = text; *p != '\0'; ) {
+    char *end;
+    long lit = strtol(p, &end, 10);
+    if (end == p) {
+      fprintf(stderr, "malformed clause near \"%.20s\"\n", p);
+      return false;
+    }
+    if (lit > (long)variables || lit < -(long)variables) {
+      fprintf(stderr, "literal %ld out of range\n", lit);
+      return false;
+    }
+    cnf[n++] = lit;
+    if (lit == 0)
+      ++seen;
+    p = end;
+    while (*p == ' ' || *p == '\n')
+      ++p;
+  }
+
+  *length = n;
+  *clauses = seen;
+  return true;
+}
+
+/** check the CNF of an AIG
+ *
+ * \param aig AIG to translate
+ * \returns True if it was as expected
+ */
+static bool check(aig_t *aig) {
+
+  char *text = NULL;
+  int rc = aig_to_cnf_string(aig, &text);
+  if (rc) {
+    fprintf(stderr, "aig_to_cnf_string: %s\n", strerror(rc));
+    return false;
+  }
+
+  // the header should count the AIG variables plus the constant, and one
+  // clause fixing the constant, two per latch, and three per AND gate
+  uint64_t max_index = aig_max_index(aig);
+  unsigned long variables, clauses;
+  int offset;
+  if (sscanf(text, "p cnf %lu %lu\n%n", &variables, &clauses, &offset) != 2) {
+    fprintf(stderr, "malformed header\n");
+    free(text);
+    return false;
+  }
+  uint64_t expected = 1 + 2 * aig_latch_count(aig) + 3 * aig_and_count(aig);
+  bool ok = true;
+  if (variables != max_index + 1) {
+    fprintf(stderr, "header has %lu variables, expected %" PRIu64 "\n",
+            variables, max_index + 1);
+    ok = false;
+  } else if (clauses != expected) {
+    fprintf(stderr, "header has %lu clauses, expected %" PRIu64 "\n", clauses,
+            expected);
+    ok = false;
+  } else if (variables > VARIABLES_MAX) {
+    fprintf(stderr, "too many variables to enumerate\n");
+    ok = false;
+  }
+
+  // read the clauses, checking every literal is in range
+  long *cnf = calloc(strlen(text) + 1, sizeof(cnf[0]));
+  if (ok && cnf == NULL) {
+    fprintf(stderr, "out of memory\n");
+    ok = false;
+  }
+  size_t n = 0;
+  unsigned long seen = 0;
+  if (ok)
+    ok = parse(text + offset, variables, cnf, &n, &seen);
+  if (ok && seen != clauses) {
+    fprintf(stderr, "found %lu clauses, expected %lu\n", seen, clauses);
+    ok = false;
+  }
+
+  // DIMACS variable v is AIG variable v, and the constant is the last variable
+  for (uint64_t bits = 0; ok && bits < UINT64_C(1) << variables; bits++) {
+
+    bool dimacs[VARIABLES_MAX + 1] = { false };
+    for (unsigned long v = 1; v <= variables; v++)
+      dimacs[v] = (bits >> (v - 1)) & 1;
+
+    bool assignment[VARIABLES_MAX + 1] = { false };
+    assignment[0] = dimacs[variables];
+    for (uint64_t v = 1; v <= max_index; v++)
+      assignment[v] = dimacs[v];
+
+    bool sat = satisfies(cnf, n, dimacs);
+    bool con = consistent(aig, assignment);
+    if (sat != con) {
+      fprintf(stderr, "assignment %#" PRIx64 " is %ssatisfying but %s\n", bits,
+              sat ? "" : "not ", con ? "consistent" : "inconsistent");
+      ok = false;
+    }
+  }
+
+  free(cnf);
+  free(text);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s filename...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+    for (int eager = 0; eager < 2; eager++) {
+      struct aig_options options = { .eager = eager };
+
+      aig_t *aig = NULL;
+      int rc = aig_load(&aig, argv[i], options);
+      if (rc) {
+        fprintf(stderr, "aig_load(%s): %s\n", argv[i], strerror(rc));
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      if (!check(aig)) {
+        fprintf(stderr, "%s failed with eager = %d\n", argv[i], eager);
+        result = EXIT_FAILURE;
+      }
+
+      aig_free(&aig);
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,379 @@
+// check cones of influence and their extraction
+//
+// For each output, and for every output at once, the cone found by aig_cone()
+// is compared against a brute-force search, both combinational and
+// sequential. The extracted AIG is then checked to have the expected header
+// and to compute the same functions as the original, by simulating both on
+// random values.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// number of rounds of 64 random assignments to simulate
+enum { ROUNDS = 8 };
+
+/// is a variable set in a bitset?
+static bool is_set(const uint64_t *bits, uint64_t v) {
+  return (bits[v / 64] >> (v % 64)) & 1;
+}
+
+/** find the node defining a variable
+ *
+ * \param aig AIG to search
+ * \param v Variable to look up
+ * \param node [out] Its first definition, if any
+ * \returns 0 if found, ERANGE if nothing defines it, or another errno
+ */
+static int definition(aig_t *aig, uint64_t v, struct aig_node *node) {
+  if (v == 0)
+    return ERANGE;
+  return aig_get_node_no_symbol(aig, v, node);
+}
+
+/** is a variable free in a cone, taking whatever value it is given?
+ *
+ * \param node Its definition
+ * \param rc Result of looking it up
+ * \param sequential Whether latches are followed
+ * \returns True if it is an input, latch cut off from its next state, or
+ *   undefined
+ */
+static bool is_free(const struct aig_node *node, int rc, bool sequential) {
+  if (rc == ERANGE)
+    return true;
+  return node->type == AIG_INPUT
+      || (node->type == AIG_LATCH && !sequential);
+}
+
+/** mark the cone of a variable by a recursive search
+ *
+ * \param aig AIG to search
+ * \param v Variable to start from
+ * \param sequential Whether to continue through latches
+ * \param cone Which variables are in the cone
+ * \returns 0 on success or an errno on failure
+ */
+static int reach(aig_t *aig, uint64_t v, bool sequential, bool *cone) {
+
+  if (cone[v])
+    return 0;
+  cone[v] = true;
+
+  struct aig_node n;
+  int rc = definition(aig, v, &n);
+  if (rc == ERANGE)
+    return 0;
+  if (rc)
+    return rc;
+
+  if (n.type == AIG_AND_GATE) {
+    if ((rc = reach(aig, n.and_gate.rhs[0], sequential, cone)))
+      return rc;
+    return reach(aig, n.and_gate.rhs[1], sequential, cone);
+  }
+
+  if (n.type == AIG_LATCH && sequential)
+    return reach(aig, n.latch.next, sequential, cone);
+
+  return 0;
+}
+
+/// a simulation of an AIG on 64 assignments at once
+typedef struct {
+  aig_t *aig;
+  bool sequential;
+  uint64_t *values;
+  bool *known;
+  const uint64_t *free_values; ///< value of each free variable, by variable
+} sim_t;
+
+/** compute the value of a variable
+ *
+ * \param s Simulation state
+ * \param v Variable to evaluate
+ * \param value [out] Its value in each of the 64 assignments
+ * \returns 0 on success or an errno on failure
+ */
+static int eval(sim_t *s, uint64_t v, uint64_t *value) {
+
+  if (s->known[v]) {
+    *value = s->values[v];
+    return 0;
+  }
+
+  struct aig_node n;
+  int rc = definition(s->aig, v, &n);
+  if (rc != 0 && rc != ERANGE)
+    return rc;
+
+  uint64_t r = 0;
+  if (v == 0) {
+    r = 0;
+  } else if (is_free(&n, rc, s->sequential) || n.type == AIG_LATCH) {
+    r = s->free_values[v];
+  } else {
+    uint64_t a, b;
+    if ((rc = eval(s, n.and_gate.rhs[0], &a)) ||
+        (rc = eval(s, n.and_gate.rhs[1], &b)))
+      return rc;
+    r = (n.and_gate.negated[0] ? ~a : a) & (n.and_gate.negated[1] ? ~b : b);
+  }
+
+  s->values[v] = r;
+  s->known[v] = true;
+  *value = r;
+  return 0;
+}
+
+/** compute the value of a literal
+ *
+ * \param s Simulation state
+ * \param literal Literal to evaluate
+ * \param value [out] Its value in each of the 64 assignments
+ * \returns 0 on success or an errno on failure
+ */
+static int eval_literal(sim_t *s, uint64_t literal, uint64_t *value) {
+  int rc = eval(s, literal / 2, value);
+  if (rc == 0 && literal % 2)
+    *value = ~*value;
+  return rc;
+}
+
+/// a pseudo-random value for a variable in a given round
+static uint64_t random_value(uint64_t round, uint64_t v) {
+  uint64_t x = (round + 1) * UINT64_C(0x9e3779b97f4a7c15) ^ (v + 1);
+  x ^= x >> 31;
+  x *= UINT64_C(0xbf58476d1ce4e5b9);
+  x ^= x >> 29;
+  return x;
+}
+
+/** check the cone and extraction of some literals
+ *
+ * \param aig AIG to examine
+ * \param literals Literals to extract the cone of
+ * \param count Number of entries in literals
+ * \param sequential Whether to continue through latches
+ * \returns True if everything was as expected
+ */
+static bool check(aig_t *aig, const uint64_t *literals, size_t count,
+    bool sequential) {
+
+  uint64_t variables = aig_max_index(aig) + 1;
+  bool *expected = calloc(variables, sizeof(expected[0]));
+  uint64_t *frees = calloc(variables, sizeof(frees[0]));
+  uint64_t *free_values = calloc(variables, sizeof(free_values[0]));
+  uint64_t *values = calloc(variables, sizeof(values[0]));
+  bool *known = calloc(variables, sizeof(known[0]));
+  uint64_t *bits = NULL;
+  aig_t *cone = NULL;
+  uint64_t *cone_values = NULL;
+  bool *cone_known = NULL;
+  bool ok = false;
+
+  if (expected == NULL || frees == NULL || free_values == NULL
+      || values == NULL || known == NULL) {
+    fprintf(stderr, "out of memory\n");
+    goto done;
+  }
+
+  int rc = 0;
+  for (size_t i = 0; rc == 0 && i < count; i++)
+    rc = reach(aig, literals[i] / 2, sequential, expected);
+  if (rc) {
+    fprintf(stderr, "%s\n", strerror(rc));
+    goto done;
+  }
+
+  // the cone should be what the brute-force search found
+  if ((rc = aig_cone(aig, literals, count, sequential, &bits))) {
+    fprintf(stderr, "aig_cone: %s\n", strerror(rc));
+    goto done;
+  }
+  for (uint64_t v = 0; v < variables; v++) {
+    if (is_set(bits, v) != expected[v]) {
+      fprintf(stderr, "variable %" PRIu64 " is %sin the cone, but should %sbe"
+              "\n", v, is_set(bits, v) ? "" : "not ", expected[v] ? "" : "not ");
+      goto done;
+    }
+  }
+
+  // count what the extracted AIG should contain, listing the free variables
+  // and then the latches in variable order as they should be numbered
+  uint64_t inputs = 0, latches = 0, ands = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    for (uint64_t v = 1; v < variables; v++) {
+      if (!expected[v])
+        continue;
+      struct aig_node n;
+      rc = definition(aig, v, &n);
+      if (rc != 0 && rc != ERANGE) {
+        fprintf(stderr, "%s\n", strerror(rc));
+        goto done;
+      }
+      bool free_var = is_free(&n, rc, sequential);
+      bool latch = rc == 0 && n.type == AIG_LATCH && sequential;
+      if (pass == 0 && free_var) {
+        frees[inputs++] = v;
+      } else if (pass == 1 && latch) {
+        frees[inputs + latches++] = v;
+      } else if (pass == 0 && rc == 0 && n.type == AIG_AND_GATE) {
+        ++ands;
+      }
+    }
+  }
+
+  if ((rc = aig_cone_extract(aig, literals, count, sequential, &cone))) {
+    fprintf(stderr, "aig_cone_extract: %s\n", strerror(rc));
+    goto done;
+  }
+
+  if (aig_input_count(cone) != inputs || aig_latch_count(cone) != latches
+      || aig_output_count(cone) != count || aig_and_count(cone) != ands
+      || aig_max_index(cone) != inputs + latches + ands) {
+    fprintf(stderr, "extracted header is M = %" PRIu64 ", I = %" PRIu64
+            ", L = %" PRIu64 ", O = %" PRIu64 ", A = %" PRIu64 "\n",
+            aig_max_index(cone), aig_input_count(cone), aig_latch_count(cone),
+            aig_output_count(cone), aig_and_count(cone));
+    goto done;
+  }
+
+  uint64_t cone_variables = aig_max_index(cone) + 1;
+  cone_values = calloc(cone_variables, sizeof(cone_values[0]));
+  cone_known = calloc(cone_variables, sizeof(cone_known[0]));
+  uint64_t *cone_free_values = calloc(cone_variables, sizeof(uint64_t));
+  if (cone_values == NULL || cone_known == NULL || cone_free_values == NULL) {
+    free(cone_free_values);
+    fprintf(stderr, "out of memory\n");
+    goto done;
+  }
+
+  // simulate both on the same values for the free variables and latches,
+  // comparing outputs and latch next states
+  ok = true;
+  for (uint64_t round = 0; ok && round < ROUNDS; round++) {
+
+    memset(known, 0, variables * sizeof(known[0]));
+    memset(cone_known, 0, cone_variables * sizeof(cone_known[0]));
+    for (uint64_t k = 0; k < inputs + latches; k++) {
+      free_values[frees[k]] = random_value(round, frees[k]);
+      cone_free_values[k + 1] = free_values[frees[k]];
+    }
+
+    sim_t original = { .aig = aig, .sequential = sequential, .values = values,
+                       .known = known, .free_values = free_values };
+    sim_t extracted = { .aig = cone, .sequential = true,
+                        .values = cone_values, .known = cone_known,
+                        .free_values = cone_free_values };
+
+    for (size_t i = 0; ok && i < count; i++) {
+      struct aig_node n;
+      uint64_t a, b;
+      if ((rc = eval_literal(&original, literals[i], &a))
+          || (rc = aig_get_output_no_symbol(cone, i, &n))
+          || (rc = eval_literal(&extracted, n.output.variable_index * 2
+                                + n.output.negated, &b))) {
+        fprintf(stderr, "%s\n", strerror(rc));
+        ok = false;
+      } else if (a != b) {
+        fprintf(stderr, "output %zu differs\n", i);
+        ok = false;
+      }
+    }
+
+    for (uint64_t k = 0; ok && k < latches; k++) {
+      struct aig_node o, n;
+      uint64_t a, b;
+      if ((rc = definition(aig, frees[inputs + k], &o))
+          || (rc = aig_get_latch_no_symbol(cone, k, &n))
+          || (rc = eval_literal(&original, o.latch.next * 2
+                                + o.latch.next_negated, &a))
+          || (rc = eval_literal(&extracted, n.latch.next * 2
+                                + n.latch.next_negated, &b))) {
+        fprintf(stderr, "%s\n", strerror(rc));
+        ok = false;
+      } else if (a != b) {
+        fprintf(stderr, "latch %" PRIu64 " next state differs\n", k);
+        ok = false;
+      }
+    }
+  }
+
+  free(cone_free_values);
+
+done:
+  if (cone != NULL)
+    aig_free(&cone);
+  free(cone_known);
+  free(cone_values);
+  free(bits);
+  free(known);
+  free(values);
+  free(free_values);
+  free(frees);
+  free(expected);
+
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s filename...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+    for (int compress = 0; compress < 2; compress++) {
+      struct aig_options options = { .compress = compress };
+
+      aig_t *aig = NULL;
+      int rc = aig_load(&aig, argv[i], options);
+      if (rc) {
+        fprintf(stderr, "aig_load(%s): %s\n", argv[i], strerror(rc));
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      uint64_t count = aig_output_count(aig);
+      uint64_t *outputs = calloc(count + 1, sizeof(outputs[0]));
+      if (outputs == NULL || (count > 0
+          && (rc = aig_get_outputs(aig, 0, count, outputs)))) {
+        fprintf(stderr, "%s: %s\n", argv[i], rc ? strerror(rc) : "out of "
+                "memory");
+        free(outputs);
+        aig_free(&aig);
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      // each output alone, and then all of them
+      for (int sequential = 0; sequential < 2; sequential++) {
+        for (uint64_t j = 0; j <= count; j++) {
+          bool all = j == count;
+          if (!check(aig, all ? outputs : &outputs[j], all ? count : 1,
+                     sequential)) {
+            fprintf(stderr, "%s failed for %" PRIu64 " output(s) from %" PRIu64
+                    " with compress = %d, sequential = %d\n", argv[i],
+                    all ? count : 1, all ? 0 : j, compress, sequential);
+            result = EXIT_FAILURE;
+          }
+        }
+      }
+
+      free(outputs);
+      aig_free(&aig);
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,275 @@
+// check fanout counts against a brute-force scan of every node
+//
+// Each AIG is checked both single threaded and with several threads. Besides
+// the files given on the command line, a generated AIG with enough AND gates
+// to be counted in parallel is checked.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// most variables to check per-node fanout counts of
+enum { VARIABLES_MAX = 1 << 18 };
+
+/// threads to use for the parallel checks
+enum { THREADS = 4 };
+
+/// size of the generated AIG
+enum { INPUTS = 100, ANDS = 200000 };
+
+/// number of nodes to retrieve at once
+enum { BLOCK = 256 };
+
+/// expected counts, indexed by variable
+typedef struct {
+  size_t *references[2][2]; ///< indexed by whether latches and outputs count
+  size_t *nodes;            ///< distinct latches and AND gates using each
+} expected_t;
+
+/** count a reference in every expected reference array that includes it
+ *
+ * \param e Expected counts
+ * \param latch Whether this is a reference from a latch
+ * \param output Whether this is a reference from an output
+ * \param literal Encoded reference
+ */
+static void add(expected_t *e, bool latch, bool output, uint64_t literal) {
+  for (int l = 0; l < 2; l++) {
+    for (int o = 0; o < 2; o++) {
+      if ((l || !latch) && (o || !output))
+        ++e->references[l][o][literal / 2];
+    }
+  }
+}
+
+/** find the expected counts by scanning every node
+ *
+ * \param aig AIG to read
+ * \param e [out] Expected counts, to be freed by the caller
+ * \returns 0 on success or an errno on failure
+ */
+static int scan(aig_t *aig, expected_t *e) {
+
+  size_t variables = (size_t)aig_max_index(aig) + 1;
+  for (int l = 0; l < 2; l++) {
+    for (int o = 0; o < 2; o++) {
+      if ((e->references[l][o] = calloc(variables, sizeof(size_t))) == NULL)
+        return ENOMEM;
+    }
+  }
+  if ((e->nodes = calloc(variables, sizeof(size_t))) == NULL)
+    return ENOMEM;
+
+  uint64_t a[BLOCK], b[BLOCK];
+  int rc = 0;
+
+  for (uint64_t i = 0; i < aig_latch_count(aig); i += BLOCK) {
+    uint64_t n = aig_latch_count(aig) - i < BLOCK ? aig_latch_count(aig) - i
+                                                  : BLOCK;
+    if ((rc = aig_get_latches(aig, i, n, NULL, a)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      add(e, true, false, a[j]);
+      ++e->nodes[a[j] / 2];
+    }
+  }
+
+  for (uint64_t i = 0; i < aig_output_count(aig); i += BLOCK) {
+    uint64_t n = aig_output_count(aig) - i < BLOCK ? aig_output_count(aig) - i
+                                                   : BLOCK;
+    if ((rc = aig_get_outputs(aig, i, n, a)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++)
+      add(e, false, true, a[j]);
+  }
+
+  for (uint64_t i = 0; i < aig_and_count(aig); i += BLOCK) {
+    uint64_t n = aig_and_count(aig) - i < BLOCK ? aig_and_count(aig) - i
+                                                : BLOCK;
+    if ((rc = aig_get_ands(aig, i, n, NULL, a, b)))
+      return rc;
+    for (uint64_t j = 0; j < n; j++) {
+      add(e, false, false, a[j]);
+      add(e, false, false, b[j]);
+      ++e->nodes[a[j] / 2];
+      if (a[j] / 2 != b[j] / 2)
+        ++e->nodes[b[j] / 2];
+    }
+  }
+
+  return 0;
+}
+
+/** check the counts of an AIG
+ *
+ * \param name Description of the AIG for error messages
+ * \param aig AIG to check
+ * \param e Expected counts
+ * \returns True if the counts were as expected
+ */
+static bool check(const char *name, aig_t *aig, const expected_t *e) {
+
+  size_t variables = (size_t)aig_max_index(aig) + 1;
+  size_t *counts = calloc(variables, sizeof(counts[0]));
+  if (counts == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return false;
+  }
+
+  bool ok = true;
+
+  for (int l = 0; l < 2 && ok; l++) {
+    for (int o = 0; o < 2 && ok; o++) {
+      int rc = aig_fanout_counts(aig, l, o, counts);
+      if (rc) {
+        fprintf(stderr, "%s: aig_fanout_counts: %s\n", name, strerror(rc));
+        ok = false;
+        break;
+      }
+      for (size_t v = 0; v < variables; v++) {
+        if (counts[v] != e->references[l][o][v]) {
+          fprintf(stderr, "%s: variable %zu has %zu references with latches = "
+                  "%d, outputs = %d, expected %zu\n", name, v, counts[v], l, o,
+                  e->references[l][o][v]);
+          ok = false;
+          break;
+        }
+      }
+    }
+  }
+
+  for (size_t v = 0; v < variables && v < VARIABLES_MAX && ok; v++) {
+    struct aig_node node;
+    if (aig_get_node_no_symbol(aig, v, &node) != 0)
+      continue; // undefined variables have no node to ask about
+
+    size_t count = 0;
+    int rc = aig_fanout_count(aig, &node, &count);
+    if (rc) {
+      fprintf(stderr, "%s: aig_fanout_count(%zu): %s\n", name, v,
+              strerror(rc));
+      ok = false;
+    } else if (count != e->nodes[v]) {
+      fprintf(stderr, "%s: variable %zu has %zu fanouts, expected %zu\n", name,
+              v, count, e->nodes[v]);
+      ok = false;
+    }
+  }
+
+  free(counts);
+  return ok;
+}
+
+/** check an AIG single threaded and with several threads
+ *
+ * \param name Description of the AIG for error messages
+ * \param filename File to load, or NULL to parse text
+ * \param text AIG to parse if filename is NULL
+ * \param length Length of text
+ * \returns True if the counts were as expected
+ */
+static bool check_all(const char *name, const char *filename, const char *text,
+    size_t length) {
+
+  expected_t e = { 0 };
+  bool ok = true;
+
+  for (size_t threads = 1; threads <= THREADS && ok; threads += THREADS - 1) {
+    struct aig_options options = { .threads = threads };
+
+    aig_t *aig = NULL;
+    int rc = filename != NULL ? aig_load(&aig, filename, options)
+                              : aig_parse_buffer(&aig, text, length, options);
+    if (rc) {
+      fprintf(stderr, "%s: %s\n", name, strerror(rc));
+      ok = false;
+      break;
+    }
+
+    if (e.nodes == NULL && (rc = scan(aig, &e))) {
+      fprintf(stderr, "%s: %s\n", name, strerror(rc));
+      ok = false;
+    }
+
+    if (ok && !check(name, aig, &e)) {
+      fprintf(stderr, "%s failed with threads = %zu\n", name, threads);
+      ok = false;
+    }
+
+    aig_free(&aig);
+  }
+
+  for (int l = 0; l < 2; l++) {
+    for (int o = 0; o < 2; o++)
+      free(e.references[l][o]);
+  }
+  free(e.nodes);
+
+  return ok;
+}
+
+/** generate an ASCII AIG
+ *
+ * Each AND gate uses two earlier variables, scattered so that some are used
+ * many times and some gates use the same variable twice.
+ *
+ * \param length [out] Length of the generated text
+ * \returns The generated text, or NULL if out of memory
+ */
+static char *generate(size_t *length) {
+
+  char *text = malloc((size_t)(INPUTS + ANDS) * 32 + 64);
+  if (text == NULL)
+    return NULL;
+
+  uint64_t max_index = INPUTS + 1 + ANDS;
+  size_t n = (size_t)sprintf(text, "aag %" PRIu64 " %d 1 1 %d\n", max_index,
+                             INPUTS, ANDS);
+
+  for (uint64_t i = 1; i <= INPUTS; i++)
+    n += (size_t)sprintf(text + n, "%" PRIu64 "\n", i * 2);
+  n += (size_t)sprintf(text + n, "%d %" PRIu64 "\n", (INPUTS + 1) * 2,
+                       max_index * 2 + 1);
+  n += (size_t)sprintf(text + n, "%" PRIu64 "\n", max_index * 2);
+
+  for (uint64_t i = 0; i < ANDS; i++) {
+    uint64_t lhs = INPUTS + 2 + i;
+    uint64_t rhs0 = i * 7919 % (lhs - 1) + 1;
+    uint64_t rhs1 = i % 5 == 0 ? rhs0 : i * 104729 % (lhs - 1) + 1;
+    n += (size_t)sprintf(text + n, "%" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+                         lhs * 2, rhs0 * 2 + i % 2, rhs1 * 2);
+  }
+
+  *length = n;
+  return text;
+}
+
+int main(int argc, char **argv) {
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+    if (!check_all(argv[i], argv[i], NULL, 0))
+      result = EXIT_FAILURE;
+  }
+
+  size_t length = 0;
+  char *text = generate(&length);
+  if (text == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return EXIT_FAILURE;
+  }
+
+  if (!check_all("generated AIG", NULL, text, length))
+    result = EXIT_FAILURE;
+
+  free(text);
+
+  return result;
+}
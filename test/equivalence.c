@@ -0,0 +1,275 @@
+// check that AIGs load identically regardless of format and load options
+//
+// The first file given is the reference, loaded with default options. Every
+// file, including the first, is then loaded with the options given on the
+// command line and compared node for node against it.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// most variables to look up individually when comparing
+enum { VARIABLES_MAX = 1 << 20 };
+
+/// compare a string that may be absent
+static bool name_eq(const char *a, const char *b) {
+  if (a == NULL || b == NULL)
+    return a == b;
+  return strcmp(a, b) == 0;
+}
+
+/// compare two nodes of the same type
+static bool node_eq(const struct aig_node *a, const struct aig_node *b) {
+
+  if (a->type != b->type)
+    return false;
+
+  switch (a->type) {
+
+    case AIG_CONSTANT:
+      return a->constant.is_true == b->constant.is_true;
+
+    case AIG_INPUT:
+      return a->input.variable_index == b->input.variable_index
+          && name_eq(a->input.name, b->input.name);
+
+    case AIG_LATCH:
+      return a->latch.current == b->latch.current
+          && a->latch.next == b->latch.next
+          && a->latch.next_negated == b->latch.next_negated
+          && name_eq(a->latch.name, b->latch.name);
+
+    case AIG_OUTPUT:
+      return a->output.variable_index == b->output.variable_index
+          && a->output.negated == b->output.negated
+          && name_eq(a->output.name, b->output.name);
+
+    case AIG_AND_GATE:
+      return a->and_gate.lhs == b->and_gate.lhs
+          && a->and_gate.rhs[0] == b->and_gate.rhs[0]
+          && a->and_gate.rhs[1] == b->and_gate.rhs[1]
+          && a->and_gate.negated[0] == b->and_gate.negated[0]
+          && a->and_gate.negated[1] == b->and_gate.negated[1];
+  }
+
+  return false;
+}
+
+/** compare one node retrieved from each AIG by the same getter
+ *
+ * \param what Description of the node for error messages
+ * \param index Index or variable index of the node
+ * \param rc_a Return value of the getter on the reference
+ * \param a Node from the reference
+ * \param rc_b Return value of the getter on the candidate
+ * \param b Node from the candidate
+ * \returns True if the nodes match
+ */
+static bool check(const char *what, uint64_t index, int rc_a,
+    const struct aig_node *a, int rc_b, const struct aig_node *b) {
+
+  if (rc_a != rc_b) {
+    fprintf(stderr, "%s %" PRIu64 ": got %s, expected %s\n", what, index,
+            strerror(rc_b), strerror(rc_a));
+    return false;
+  }
+
+  if (rc_a == 0 && !node_eq(a, b)) {
+    fprintf(stderr, "%s %" PRIu64 ": nodes differ\n", what, index);
+    return false;
+  }
+
+  return true;
+}
+
+/// bytes placed after a buffer’s contents, which must never be read
+static const char PADDING[] = "1234567890 i0 junk\n";
+
+/** load an AIG by reading a file into memory and parsing it from there
+ *
+ * The buffer is followed by PADDING, so reading beyond its end changes what
+ * is parsed.
+ *
+ * \param aig [out] The loaded AIG on success
+ * \param data [out] The buffer, to be freed after the AIG, on success
+ * \param filename File to read
+ * \param options Options to parse with
+ * \returns 0 on success or an errno on failure
+ */
+static int load_buffer(aig_t **aig, char **data, const char *filename,
+    struct aig_options options) {
+
+  FILE *f = fopen(filename, "rb");
+  if (f == NULL)
+    return errno;
+
+  // read the whole file, growing the buffer as we go
+  char *buffer = NULL;
+  size_t size = 0;
+  size_t capacity = 0;
+  for (;;) {
+    if (capacity - size < sizeof(PADDING)) {
+      capacity = capacity == 0 ? BUFSIZ : capacity * 2;
+      char *b = realloc(buffer, capacity);
+      if (b == NULL) {
+        free(buffer);
+        fclose(f);
+        return ENOMEM;
+      }
+      buffer = b;
+    }
+    size_t n = fread(buffer + size, 1, capacity - size - sizeof(PADDING), f);
+    if (n == 0)
+      break;
+    size += n;
+  }
+
+  int rc = ferror(f) ? EIO : 0;
+  fclose(f);
+  if (rc) {
+    free(buffer);
+    return rc;
+  }
+
+  memcpy(buffer + size, PADDING, sizeof(PADDING));
+
+  if ((rc = aig_parse_buffer(aig, buffer, size, options))) {
+    free(buffer);
+    return rc;
+  }
+
+  *data = buffer;
+  return 0;
+}
+
+/** compare an AIG against a reference
+ *
+ * \param ref Reference AIG
+ * \param aig AIG to compare
+ * \returns True if they match
+ */
+static bool compare(aig_t *ref, aig_t *aig) {
+
+  if (aig_max_index(ref) != aig_max_index(aig)
+      || aig_input_count(ref) != aig_input_count(aig)
+      || aig_latch_count(ref) != aig_latch_count(aig)
+      || aig_output_count(ref) != aig_output_count(aig)
+      || aig_and_count(ref) != aig_and_count(aig)) {
+    fprintf(stderr, "headers differ\n");
+    return false;
+  }
+
+  struct aig_node a, b;
+  int rc_a, rc_b;
+
+  for (uint64_t i = 0; i < aig_input_count(ref); i++) {
+    rc_a = aig_get_input(ref, i, &a);
+    rc_b = aig_get_input(aig, i, &b);
+    if (!check("input", i, rc_a, &a, rc_b, &b))
+      return false;
+  }
+
+  for (uint64_t i = 0; i < aig_latch_count(ref); i++) {
+    rc_a = aig_get_latch(ref, i, &a);
+    rc_b = aig_get_latch(aig, i, &b);
+    if (!check("latch", i, rc_a, &a, rc_b, &b))
+      return false;
+  }
+
+  for (uint64_t i = 0; i < aig_output_count(ref); i++) {
+    rc_a = aig_get_output(ref, i, &a);
+    rc_b = aig_get_output(aig, i, &b);
+    if (!check("output", i, rc_a, &a, rc_b, &b))
+      return false;
+  }
+
+  for (uint64_t i = 0; i < aig_and_count(ref); i++) {
+    rc_a = aig_get_and(ref, i, &a);
+    rc_b = aig_get_and(aig, i, &b);
+    if (!check("AND gate", i, rc_a, &a, rc_b, &b))
+      return false;
+  }
+
+  // look up every variable, unless there are too many to do so in reasonable
+  // time, in which case check around the defined ones
+  uint64_t variables = aig_max_index(ref) < VARIABLES_MAX
+                     ? aig_max_index(ref) + 1 : VARIABLES_MAX;
+  for (uint64_t i = 0; i < variables; i++) {
+    rc_a = aig_get_node(ref, i, &a);
+    rc_b = aig_get_node(aig, i, &b);
+    if (!check("variable", i, rc_a, &a, rc_b, &b))
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv) {
+
+  const char *argv0 = argv[0];
+
+  // how should the files being compared be loaded?
+  struct aig_options options = { 0 };
+  bool buffer = false;
+  for (; argc > 1 && strncmp(argv[1], "--", 2) == 0; --argc, ++argv) {
+    if (strcmp(argv[1], "--eager") == 0) {
+      options.eager = true;
+    } else if (strcmp(argv[1], "--strict") == 0) {
+      options.strict = true;
+    } else if (strcmp(argv[1], "--memory-map") == 0) {
+      options.memory_map = true;
+    } else if (strcmp(argv[1], "--buffer") == 0) {
+      buffer = true;
+    } else if (strcmp(argv[1], "--compress") == 0) {
+      options.compress = true;
+    } else {
+      fprintf(stderr, "unknown option %s\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s [--strict] [--eager] [--memory-map] [--buffer] "
+            "[--compress] reference [filename...]\n", argv0);
+    return EXIT_FAILURE;
+  }
+
+  aig_t *ref = NULL;
+  int rc = aig_load(&ref, argv[1], (struct aig_options){ 0 });
+  if (rc != 0) {
+    fprintf(stderr, "aig_load(%s): %s\n", argv[1], strerror(rc));
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+
+    aig_t *aig = NULL;
+    char *data = NULL;
+    rc = buffer ? load_buffer(&aig, &data, argv[i], options)
+                : aig_load(&aig, argv[i], options);
+    if (rc) {
+      fprintf(stderr, "loading %s: %s\n", argv[i], strerror(rc));
+      result = EXIT_FAILURE;
+      continue;
+    }
+
+    if (!compare(ref, aig)) {
+      fprintf(stderr, "%s differs from %s\n", argv[i], argv[1]);
+      result = EXIT_FAILURE;
+    }
+
+    aig_free(&aig);
+    free(data);
+  }
+
+  aig_free(&ref);
+
+  return result;
+}
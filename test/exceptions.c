@@ -0,0 +1,184 @@
+// check that inputs, latches and AND gates out of their inferred sequence read
+// back as written
+//
+// The AIG is generated in memory, with every so often a node numbered out of
+// sequence. Every node is then read back, one at a time and in bulk, and
+// compared against what was generated.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { INPUTS = 3000, LATCHES = 3000, ANDS = 3000 };
+
+enum { NODES = INPUTS + LATCHES + ANDS };
+
+/// how often a node is out of sequence
+enum { PERIOD = 37 };
+
+/** the variable a node defines
+ *
+ * Each node defines the variable following those before it, except for the
+ * occasional one that swaps with its successor. This means some variables are
+ * defined out of sequence while every variable is still defined exactly once.
+ *
+ * \param position Position of the node, counting through inputs, latches, and
+ *   then AND gates
+ * \returns The variable index
+ */
+static uint64_t variable(uint64_t position) {
+  if (position % PERIOD == 5 && position + 1 < NODES)
+    return position + 2;
+  if (position % PERIOD == 6)
+    return position;
+  return position + 1;
+}
+
+/** generate an ASCII AIG
+ *
+ * \param length [out] Length of the generated text
+ * \returns The generated text, or NULL if out of memory
+ */
+static char *generate(size_t *length) {
+
+  char *text = malloc((size_t)NODES * 24 + 64);
+  if (text == NULL)
+    return NULL;
+
+  size_t n = (size_t)sprintf(text, "aag %d %d %d 0 %d\n", NODES, INPUTS,
+                             LATCHES, ANDS);
+
+  uint64_t p = 0;
+  for (uint64_t i = 0; i < INPUTS; i++, p++)
+    n += (size_t)sprintf(text + n, "%" PRIu64 "\n", variable(p) * 2);
+  for (uint64_t i = 0; i < LATCHES; i++, p++)
+    n += (size_t)sprintf(text + n, "%" PRIu64 " %" PRIu64 "\n",
+                         variable(p) * 2, variable(i) * 2 + 1);
+  for (uint64_t i = 0; i < ANDS; i++, p++)
+    n += (size_t)sprintf(text + n, "%" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+                         variable(p) * 2, variable(i) * 2,
+                         variable(i + 1) * 2 + 1);
+
+  *length = n;
+  return text;
+}
+
+/** read back every node and compare it against what was generated
+ *
+ * \param aig AIG to read from
+ * \returns True if everything matched
+ */
+static bool check(aig_t *aig) {
+
+  static uint64_t a[NODES], b[NODES], c[NODES];
+  struct aig_node node;
+  int rc = 0;
+
+  // read everything back in bulk, starting with the AND gates so that in lazy
+  // mode these are what parse the inputs and latches
+  if ((rc = aig_get_ands(aig, 0, ANDS, a, b, c))) {
+    fprintf(stderr, "aig_get_ands: %s\n", strerror(rc));
+    return false;
+  }
+  for (uint64_t i = 0; i < ANDS; i++) {
+    if (a[i] != variable(INPUTS + LATCHES + i) * 2 || b[i] != variable(i) * 2
+        || c[i] != variable(i + 1) * 2 + 1) {
+      fprintf(stderr, "AND gate %" PRIu64 " read back incorrectly in bulk\n",
+              i);
+      return false;
+    }
+  }
+
+  if ((rc = aig_get_inputs(aig, 0, INPUTS, a))) {
+    fprintf(stderr, "aig_get_inputs: %s\n", strerror(rc));
+    return false;
+  }
+  if ((rc = aig_get_latches(aig, 0, LATCHES, b, c))) {
+    fprintf(stderr, "aig_get_latches: %s\n", strerror(rc));
+    return false;
+  }
+  for (uint64_t i = 0; i < INPUTS; i++) {
+    if (a[i] != variable(i) * 2) {
+      fprintf(stderr, "input %" PRIu64 " read back incorrectly in bulk\n", i);
+      return false;
+    }
+  }
+  for (uint64_t i = 0; i < LATCHES; i++) {
+    if (b[i] != variable(INPUTS + i) * 2 || c[i] != variable(i) * 2 + 1) {
+      fprintf(stderr, "latch %" PRIu64 " read back incorrectly in bulk\n", i);
+      return false;
+    }
+  }
+
+  // and then one at a time
+  for (uint64_t i = 0; i < INPUTS; i++) {
+    if ((rc = aig_get_input_no_symbol(aig, i, &node))
+        || node.input.variable_index != variable(i)) {
+      fprintf(stderr, "input %" PRIu64 " read back incorrectly\n", i);
+      return false;
+    }
+  }
+  for (uint64_t i = 0; i < LATCHES; i++) {
+    if ((rc = aig_get_latch_no_symbol(aig, i, &node))
+        || node.latch.current != variable(INPUTS + i)
+        || node.latch.next != variable(i) || !node.latch.next_negated) {
+      fprintf(stderr, "latch %" PRIu64 " read back incorrectly\n", i);
+      return false;
+    }
+  }
+  for (uint64_t i = 0; i < ANDS; i++) {
+    if ((rc = aig_get_and(aig, i, &node))
+        || node.and_gate.lhs != variable(INPUTS + LATCHES + i)
+        || node.and_gate.rhs[0] != variable(i)
+        || node.and_gate.rhs[1] != variable(i + 1)
+        || node.and_gate.negated[0] || !node.and_gate.negated[1]) {
+      fprintf(stderr, "AND gate %" PRIu64 " read back incorrectly\n", i);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(void) {
+
+  size_t length = 0;
+  char *text = generate(&length);
+  if (text == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int eager = 0; eager < 2; eager++) {
+    for (int compress = 0; compress < 2; compress++) {
+      struct aig_options options = { .eager = eager, .compress = compress };
+
+      aig_t *aig = NULL;
+      int rc = aig_parse_buffer(&aig, text, length, options);
+      if (rc) {
+        fprintf(stderr, "aig_parse_buffer: %s\n", strerror(rc));
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      if (!check(aig)) {
+        fprintf(stderr, "failed with eager = %d, compress = %d\n", eager,
+                compress);
+        result = EXIT_FAILURE;
+      }
+
+      aig_free(&aig);
+    }
+  }
+
+  free(text);
+
+  return result;
+}
@@ -0,0 +1,189 @@
+// check fanout iteration against a brute-force scan of every latch and AND gate
+//
+// For each variable, the fanout iterator should yield each latch whose next
+// state and each AND gate with an operand that is that variable, once each, in
+// the order latches and then AND gates appear, along with the pins they use
+// it through.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// most variables to check
+enum { VARIABLES_MAX = 1 << 12 };
+
+/// compare two latches or AND gates, ignoring names
+static bool node_eq(const struct aig_node *a, const struct aig_node *b) {
+
+  if (a->type != b->type)
+    return false;
+
+  if (a->type == AIG_LATCH)
+    return a->latch.current == b->latch.current
+        && a->latch.next == b->latch.next
+        && a->latch.next_negated == b->latch.next_negated;
+
+  return a->type == AIG_AND_GATE
+      && a->and_gate.lhs == b->and_gate.lhs
+      && a->and_gate.rhs[0] == b->and_gate.rhs[0]
+      && a->and_gate.rhs[1] == b->and_gate.rhs[1]
+      && a->and_gate.negated[0] == b->and_gate.negated[0]
+      && a->and_gate.negated[1] == b->and_gate.negated[1];
+}
+
+/** get the next expected fanout of a variable
+ *
+ * \param aig AIG to scan
+ * \param v Variable whose fanouts to find
+ * \param position [in,out] Position to scan from, counting latches and then
+ *   AND gates, advanced past the fanout found
+ * \param node [out] The fanout found
+ * \param pins [out] The pins it uses v through
+ * \returns 0 if a fanout was found, ENOENT if there are no more, or another
+ *   errno on failure
+ */
+static int expected_next(aig_t *aig, uint64_t v, uint64_t *position,
+    struct aig_node *node, unsigned *pins) {
+
+  for (; *position < aig_latch_count(aig) + aig_and_count(aig); ++*position) {
+
+    int rc = 0;
+    unsigned p = 0;
+    if (*position < aig_latch_count(aig)) {
+      if ((rc = aig_get_latch(aig, *position, node)))
+        return rc;
+      p = node->latch.next == v;
+    } else {
+      if ((rc = aig_get_and(aig, *position - aig_latch_count(aig), node)))
+        return rc;
+      p = (node->and_gate.rhs[0] == v) | (node->and_gate.rhs[1] == v) << 1;
+    }
+
+    if (p != 0) {
+      ++*position;
+      *pins = p;
+      return 0;
+    }
+  }
+
+  return ENOENT;
+}
+
+/** check the fanouts of a variable
+ *
+ * \param aig AIG to examine
+ * \param v Variable to check
+ * \returns True if they were as expected
+ */
+static bool check(aig_t *aig, uint64_t v) {
+
+  struct aig_node node;
+  if (aig_get_node(aig, v, &node) != 0)
+    return true; // undefined variables have no node to ask about
+
+  aig_node_iter_t *it = NULL;
+  int rc = aig_iter_fanout(aig, &node, &it);
+  if (rc) {
+    fprintf(stderr, "aig_iter_fanout(%" PRIu64 "): %s\n", v, strerror(rc));
+    return false;
+  }
+
+  bool ok = true;
+
+  // nothing has been yielded, so there should be no pins yet
+  unsigned pins;
+  if (aig_iter_fanout_pins(it, &pins) != EINVAL) {
+    fprintf(stderr, "variable %" PRIu64 ": pins before first fanout\n", v);
+    ok = false;
+  }
+
+  uint64_t position = 0;
+  for (uint64_t i = 0; ok; i++) {
+
+    struct aig_node expected;
+    unsigned expected_pins = 0;
+    rc = expected_next(aig, v, &position, &expected, &expected_pins);
+    if (rc != 0 && rc != ENOENT) {
+      fprintf(stderr, "variable %" PRIu64 ": %s\n", v, strerror(rc));
+      ok = false;
+      break;
+    }
+
+    if (aig_iter_has_next(it) != (rc == 0)) {
+      fprintf(stderr, "variable %" PRIu64 ": %s fanouts than expected\n", v,
+              rc == 0 ? "fewer" : "more");
+      ok = false;
+      break;
+    }
+    if (rc == ENOENT)
+      break;
+
+    struct aig_node got;
+    if ((rc = aig_iter_next(it, &got))) {
+      fprintf(stderr, "variable %" PRIu64 ": aig_iter_next: %s\n", v,
+              strerror(rc));
+      ok = false;
+    } else if (!node_eq(&got, &expected)) {
+      fprintf(stderr, "variable %" PRIu64 ": fanout %" PRIu64 " differs\n", v,
+              i);
+      ok = false;
+    } else if ((rc = aig_iter_fanout_pins(it, &pins)) || pins != expected_pins) {
+      fprintf(stderr, "variable %" PRIu64 ": fanout %" PRIu64 " pins %u, "
+              "expected %u\n", v, i, rc ? 0 : pins, expected_pins);
+      ok = false;
+    }
+  }
+
+  aig_iter_free(&it);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s filename...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+
+    aig_t *aig = NULL;
+    int rc = aig_load(&aig, argv[i], (struct aig_options){ 0 });
+    if (rc) {
+      fprintf(stderr, "aig_load(%s): %s\n", argv[i], strerror(rc));
+      result = EXIT_FAILURE;
+      continue;
+    }
+
+    bool ok = true;
+    uint64_t variables = aig_max_index(aig) < VARIABLES_MAX
+                       ? aig_max_index(aig) + 1 : VARIABLES_MAX;
+    for (uint64_t v = 0; v < variables; v++)
+      ok &= check(aig, v);
+
+    // pins are only available from fanout iterators
+    aig_node_iter_t *it = NULL;
+    unsigned pins;
+    if ((rc = aig_iter(aig, &it)) || aig_iter_fanout_pins(it, &pins) != EINVAL) {
+      fprintf(stderr, "pins of a non-fanout iterator were not rejected\n");
+      ok = false;
+    }
+    aig_iter_free(&it);
+
+    if (!ok) {
+      fprintf(stderr, "%s failed\n", argv[i]);
+      result = EXIT_FAILURE;
+    }
+
+    aig_free(&aig);
+  }
+
+  return result;
+}
@@ -0,0 +1,223 @@
+// check transitive fanouts
+//
+// For each variable, and for every variable at once, the fanout found by
+// aig_fanout_cone() is compared against a brute-force fixpoint over the first
+// definition of every variable, both combinational and sequential, along with
+// the outputs it reports as affected.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// is a variable set in a bitset?
+static bool is_set(const uint64_t *bits, uint64_t v) {
+  return (bits[v / 64] >> (v % 64)) & 1;
+}
+
+/** grow a fanout until nothing more is added
+ *
+ * Only the first definition of each variable is considered, as that is the
+ * one its users see.
+ *
+ * \param aig AIG to search
+ * \param sequential Whether to continue through latches
+ * \param fanout Which variables are in the fanout, initially the seeds
+ * \returns 0 on success or an errno on failure
+ */
+static int reach(aig_t *aig, bool sequential, bool *fanout) {
+
+  for (bool changed = true; changed; ) {
+    changed = false;
+    for (uint64_t v = 1; v <= aig_max_index(aig); v++) {
+
+      if (fanout[v])
+        continue;
+
+      struct aig_node n;
+      int rc = aig_get_node_no_symbol(aig, v, &n);
+      if (rc == ERANGE)
+        continue;
+      if (rc)
+        return rc;
+
+      bool affected = false;
+      if (n.type == AIG_AND_GATE) {
+        affected = fanout[n.and_gate.rhs[0]] || fanout[n.and_gate.rhs[1]];
+      } else if (n.type == AIG_LATCH && sequential) {
+        affected = fanout[n.latch.next];
+      }
+
+      if (affected) {
+        fanout[v] = true;
+        changed = true;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/** check the fanout of some variables against a brute-force search
+ *
+ * \param aig AIG to examine
+ * \param variables Variables to start from
+ * \param count Number of entries in variables
+ * \param sequential Whether to continue through latches
+ * \returns True if aig_fanout_cone() agreed
+ */
+static bool check(aig_t *aig, const uint64_t *variables, size_t count,
+    bool sequential) {
+
+  uint64_t max = aig_max_index(aig);
+  bool *expected = calloc(max + 1, sizeof(expected[0]));
+  if (expected == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return false;
+  }
+
+  for (size_t i = 0; i < count; i++)
+    expected[variables[i]] = true;
+
+  int rc = reach(aig, sequential, expected);
+  if (rc) {
+    fprintf(stderr, "%s\n", strerror(rc));
+    free(expected);
+    return false;
+  }
+
+  uint64_t *bits = NULL;
+  uint64_t *outputs = NULL;
+  size_t output_count = 0;
+  if ((rc = aig_fanout_cone(aig, variables, count, sequential, &bits, &outputs,
+                            &output_count))) {
+    fprintf(stderr, "aig_fanout_cone: %s\n", strerror(rc));
+    free(expected);
+    return false;
+  }
+
+  bool ok = true;
+  for (uint64_t v = 0; ok && v <= max; v++) {
+    if (is_set(bits, v) != expected[v]) {
+      fprintf(stderr, "variable %" PRIu64 " is %sin the fanout, expected %s"
+              "\n", v, is_set(bits, v) ? "" : "not ", expected[v] ? "" : "not ");
+      ok = false;
+    }
+  }
+
+  // the affected outputs are those reading a variable in the fanout
+  size_t j = 0;
+  for (uint64_t i = 0; ok && i < aig_output_count(aig); i++) {
+    struct aig_node n;
+    if ((rc = aig_get_output_no_symbol(aig, i, &n))) {
+      fprintf(stderr, "aig_get_output_no_symbol(%" PRIu64 "): %s\n", i,
+              strerror(rc));
+      ok = false;
+      break;
+    }
+    bool want = expected[n.output.variable_index];
+    bool got = j < output_count && outputs[j] == i;
+    if (got != want) {
+      fprintf(stderr, "output %" PRIu64 " is %saffected, expected %s\n", i,
+              got ? "" : "not ", want ? "affected" : "not affected");
+      ok = false;
+    }
+    j += got;
+  }
+  if (ok && j != output_count) {
+    fprintf(stderr, "unexpected affected outputs\n");
+    ok = false;
+  }
+
+  free(outputs);
+  free(bits);
+  free(expected);
+  return ok;
+}
+
+/** check the fanouts of an AIG
+ *
+ * \param aig AIG to examine
+ * \param sequential Whether to continue through latches
+ * \returns True if they were all as expected
+ */
+static bool check_all(aig_t *aig, bool sequential) {
+
+  uint64_t max = aig_max_index(aig);
+  uint64_t *variables = calloc(max + 1, sizeof(variables[0]));
+  if (variables == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return false;
+  }
+
+  bool ok = true;
+  for (uint64_t v = 0; ok && v <= max; v++) {
+    variables[v] = v;
+    if (!check(aig, &variables[v], 1, sequential)) {
+      fprintf(stderr, "fanout of variable %" PRIu64 " failed\n", v);
+      ok = false;
+    }
+  }
+
+  if (ok && !check(aig, variables, max + 1, sequential)) {
+    fprintf(stderr, "fanout of all variables failed\n");
+    ok = false;
+  }
+
+  // a variable beyond the AIG should be rejected
+  uint64_t beyond = max + 1;
+  uint64_t *bits = NULL;
+  int rc;
+  if (ok && (rc = aig_fanout_cone(aig, &beyond, 1, sequential, &bits, NULL,
+                                  NULL)) != ERANGE) {
+    fprintf(stderr, "aig_fanout_cone(%" PRIu64 "): got %s, expected %s\n",
+            beyond, strerror(rc), strerror(ERANGE));
+    if (rc == 0)
+      free(bits);
+    ok = false;
+  }
+
+  free(variables);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s filename...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+    for (int eager = 0; eager < 2; eager++) {
+      struct aig_options options = { .eager = eager };
+
+      aig_t *aig = NULL;
+      int rc = aig_load(&aig, argv[i], options);
+      if (rc) {
+        fprintf(stderr, "aig_load(%s): %s\n", argv[i], strerror(rc));
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      for (int sequential = 0; sequential < 2; sequential++) {
+        if (!check_all(aig, sequential)) {
+          fprintf(stderr, "%s failed with eager = %d, sequential = %d\n",
+                  argv[i], eager, sequential);
+          result = EXIT_FAILURE;
+        }
+      }
+
+      aig_free(&aig);
+    }
+  }
+
+  return result;
+}
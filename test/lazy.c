@@ -0,0 +1,111 @@
+// check that symbol-free lookup and iteration only parse as far as they reach
+//
+// The AIG given must be ASCII, with its last AND gate malformed. Loaded lazily,
+// every node before that gate should still be retrievable without symbols,
+// whereas anything retrieving symbols has to parse past the gate and fail.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** check lookups of the first input
+ *
+ * \param filename AIG to load
+ * \returns True if they behaved as expected
+ */
+static bool check_lookup(const char *filename) {
+
+  aig_t *aig = NULL;
+  int rc = aig_load(&aig, filename, (struct aig_options){ 0 });
+  if (rc) {
+    fprintf(stderr, "aig_load(%s): %s\n", filename, strerror(rc));
+    return false;
+  }
+
+  bool ok = true;
+  struct aig_node node;
+
+  // the first input is defined before the malformed gate
+  if ((rc = aig_get_node_no_symbol(aig, 1, &node))) {
+    fprintf(stderr, "aig_get_node_no_symbol(1): %s\n", strerror(rc));
+    ok = false;
+  } else if (node.type != AIG_INPUT || node.input.variable_index != 1) {
+    fprintf(stderr, "aig_get_node_no_symbol(1) found the wrong node\n");
+    ok = false;
+  }
+
+  // but its symbol lies beyond it
+  if (aig_get_node(aig, 1, &node) == 0) {
+    fprintf(stderr, "aig_get_node(1) parsed past the malformed gate\n");
+    ok = false;
+  }
+
+  aig_free(&aig);
+  return ok;
+}
+
+/** check iteration over every node
+ *
+ * \param filename AIG to load
+ * \param symbol Whether to iterate with symbols
+ * \returns True if iteration behaved as expected
+ */
+static bool check_iter(const char *filename, bool symbol) {
+
+  aig_t *aig = NULL;
+  int rc = aig_load(&aig, filename, (struct aig_options){ 0 });
+  if (rc) {
+    fprintf(stderr, "aig_load(%s): %s\n", filename, strerror(rc));
+    return false;
+  }
+
+  aig_node_iter_t *it = NULL;
+  rc = symbol ? aig_iter(aig, &it) : aig_iter_no_symbol(aig, &it);
+  if (rc) {
+    fprintf(stderr, "aig_iter: %s\n", strerror(rc));
+    aig_free(&aig);
+    return false;
+  }
+
+  // the iterator yields inputs, latches, outputs, and then AND gates, so every
+  // node but the last is before the malformed gate
+  uint64_t total = aig_input_count(aig) + aig_latch_count(aig)
+                 + aig_output_count(aig) + aig_and_count(aig);
+  uint64_t expected = symbol ? 0 : total - 1;
+
+  uint64_t yielded = 0;
+  while (aig_iter_has_next(it)) {
+    struct aig_node node;
+    if (aig_iter_next(it, &node) != 0)
+      break;
+    ++yielded;
+  }
+
+  bool ok = yielded == expected;
+  if (!ok)
+    fprintf(stderr, "iterator %s symbols yielded %" PRIu64 " nodes, expected %"
+            PRIu64 "\n", symbol ? "with" : "without", yielded, expected);
+
+  aig_iter_free(&it);
+  aig_free(&aig);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s filename\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bool ok = check_lookup(argv[1]);
+  ok &= check_iter(argv[1], false);
+  ok &= check_iter(argv[1], true);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+// check that levels computed with threads agree with a single threaded sweep
+//
+// The AIG is generated in memory, large enough to be levelized in parallel,
+// with latches fed back from AND gates. Levels are computed for it single
+// threaded and with several threads, with the AND gates written both in order
+// and reversed, and compared against levels computed as it was generated.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { INPUTS = 100, LATCHES = 100, ANDS = 300000 };
+
+enum { MAX_INDEX = INPUTS + LATCHES + ANDS };
+
+/// threads to use for the parallel checks
+enum { THREADS = 4 };
+
+/// expected level of every variable
+static uint32_t expected[MAX_INDEX + 1];
+
+/** pick an operand of an AND gate
+ *
+ * Operands are mostly scattered over all the earlier variables, so the AIG is
+ * wide enough for some waves to be spread across threads, with the occasional
+ * recent variable to add some depth.
+ *
+ * \param i Index of the AND gate
+ * \param pin Which operand to pick
+ * \returns Variable index of the operand
+ */
+static uint64_t operand(uint64_t i, int pin) {
+  uint64_t lhs = INPUTS + LATCHES + 1 + i;
+  uint64_t h = (i + 1) * (pin ? 104729 : 7919);
+  if (h % 61 == 0 && lhs > 64)
+    return lhs - 1 - h % 64;
+  return h % (lhs - 1) + 1;
+}
+
+/** generate an ASCII AIG, and the expected levels of its variables
+ *
+ * \param reverse Whether to write the AND gates in reverse order
+ * \param length [out] Length of the generated text
+ * \returns The generated text, or NULL if out of memory
+ */
+static char *generate(bool reverse, size_t *length) {
+
+  char *text = malloc((size_t)MAX_INDEX * 32 + 64);
+  if (text == NULL)
+    return NULL;
+
+  size_t n = (size_t)sprintf(text, "aag %d %d %d 1 %d\n", MAX_INDEX, INPUTS,
+                             LATCHES, ANDS);
+
+  for (uint64_t v = 0; v <= INPUTS + LATCHES; v++)
+    expected[v] = 0;
+
+  for (uint64_t i = 1; i <= INPUTS; i++)
+    n += (size_t)sprintf(text + n, "%" PRIu64 "\n", i * 2);
+  for (uint64_t i = 0; i < LATCHES; i++)
+    n += (size_t)sprintf(text + n, "%" PRIu64 " %" PRIu64 "\n",
+                         (INPUTS + 1 + i) * 2,
+                         (MAX_INDEX - i * 997 % ANDS) * 2 + i % 2);
+  n += (size_t)sprintf(text + n, "%d\n", MAX_INDEX * 2);
+
+  for (uint64_t i = 0; i < ANDS; i++) {
+    uint64_t lhs = INPUTS + LATCHES + 1 + i;
+    uint64_t a = operand(i, 0);
+    uint64_t b = operand(i, 1);
+    expected[lhs] = (expected[a] > expected[b] ? expected[a] : expected[b]) + 1;
+  }
+
+  for (uint64_t k = 0; k < ANDS; k++) {
+    uint64_t i = reverse ? ANDS - 1 - k : k;
+    n += (size_t)sprintf(text + n, "%" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+                         (INPUTS + LATCHES + 1 + i) * 2,
+                         operand(i, 0) * 2 + i % 2, operand(i, 1) * 2);
+  }
+
+  *length = n;
+  return text;
+}
+
+int main(void) {
+
+  int result = EXIT_SUCCESS;
+
+  for (int reverse = 0; reverse < 2; reverse++) {
+
+    size_t length = 0;
+    char *text = generate(reverse, &length);
+    if (text == NULL) {
+      fprintf(stderr, "out of memory\n");
+      return EXIT_FAILURE;
+    }
+
+    for (size_t threads = 1; threads <= THREADS; threads += THREADS - 1) {
+      struct aig_options options = { .threads = threads };
+
+      aig_t *aig = NULL;
+      int rc = aig_parse_buffer(&aig, text, length, options);
+      if (rc) {
+        fprintf(stderr, "aig_parse_buffer: %s\n", strerror(rc));
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      const uint32_t *levels = NULL;
+      if ((rc = aig_levels(aig, &levels))) {
+        fprintf(stderr, "aig_levels: %s\n", strerror(rc));
+        result = EXIT_FAILURE;
+      } else {
+        for (uint64_t v = 0; v <= MAX_INDEX; v++) {
+          if (levels[v] != expected[v]) {
+            fprintf(stderr, "variable %" PRIu64 " has level %" PRIu32
+                    ", expected %" PRIu32 " with reverse = %d, threads = %zu\n",
+                    v, levels[v], expected[v], reverse, threads);
+            result = EXIT_FAILURE;
+            break;
+          }
+        }
+      }
+
+      aig_free(&aig);
+    }
+
+    free(text);
+  }
+
+  return result;
+}
@@ -0,0 +1,316 @@
+// check the levels and depths computed for an AIG
+//
+// Expected values are given as space separated lists with one entry per
+// variable, starting at the constant. A depth of "-" means no output or latch
+// next state is reachable from that variable. Alternatively, "ELOOP" as the
+// expected levels means the AIG is expected to contain a combinational cycle.
+// The level, depth and slack of every node, and the critical variables, are
+// also checked to agree with these.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// the ways of loading an AIG to exercise, sequential and parallel
+static const struct aig_options OPTIONS[] = {
+  { 0 },
+  { .memory_map = true, .threads = 4 },
+};
+
+/** compare computed values against an expected list
+ *
+ * \param what Description of the values for error messages
+ * \param values Computed values
+ * \param count Number of computed values
+ * \param expected Space separated list of expected values
+ * \returns True if they match
+ */
+static bool check(const char *what, const uint32_t *values, uint64_t count,
+    const char *expected) {
+
+  const char *p = expected;
+  for (uint64_t i = 0; i < count; i++) {
+
+    while (*p == ' ')
+      ++p;
+
+    uint32_t e;
+    if (*p == '-') {
+      e = UINT32_MAX;
+      ++p;
+    } else {
+      char *end;
+      unsigned long v = strtoul(p, &end, 10);
+      if (end == p) {
+        fprintf(stderr, "too few expected %s\n", what);
+        return false;
+      }
+      e = (uint32_t)v;
+      p = end;
+    }
+
+    if (values[i] != e) {
+      fprintf(stderr, "%s of variable %" PRIu64 ": got %" PRIu32 ", expected "
+              "%" PRIu32 "\n", what, i, values[i], e);
+      return false;
+    }
+  }
+
+  while (*p == ' ')
+    ++p;
+  if (*p != '\0') {
+    fprintf(stderr, "too many expected %s\n", what);
+    return false;
+  }
+
+  return true;
+}
+
+/** check that every node’s level agrees with that of its variable
+ *
+ * Inputs and latches are level 0, even if an AND gate later redefines their
+ * variable, so their level is compared against 0 rather than the variable.
+ *
+ * \param aig AIG to examine
+ * \param levels Level of every variable
+ * \returns True if they agree
+ */
+static bool check_nodes(aig_t *aig, const uint32_t *levels) {
+
+  aig_node_iter_t *it = NULL;
+  int rc = aig_iter_no_symbol(aig, &it);
+  if (rc) {
+    fprintf(stderr, "aig_iter_no_symbol: %s\n", strerror(rc));
+    return false;
+  }
+
+  bool ok = true;
+  while (ok && aig_iter_has_next(it)) {
+
+    struct aig_node n;
+    if ((rc = aig_iter_next(it, &n))) {
+      fprintf(stderr, "aig_iter_next: %s\n", strerror(rc));
+      ok = false;
+      break;
+    }
+
+    // only the first definition of a variable determines its level
+    uint64_t v = 0;
+    size_t expected = 0;
+    switch (n.type) {
+      case AIG_CONSTANT:
+      case AIG_INPUT:
+      case AIG_LATCH:
+        break;
+      case AIG_OUTPUT:
+        v = n.output.variable_index;
+        expected = levels[v];
+        break;
+      case AIG_AND_GATE: {
+        v = n.and_gate.lhs;
+        struct aig_node first;
+        if ((rc = aig_get_node_no_symbol(aig, v, &first))) {
+          fprintf(stderr, "aig_get_node_no_symbol(%" PRIu64 "): %s\n", v,
+                  strerror(rc));
+          ok = false;
+          continue;
+        }
+        if (first.type != AIG_AND_GATE)
+          continue;
+        expected = levels[v];
+        break;
+      }
+    }
+
+    size_t level;
+    if ((rc = aig_node_level(aig, &n, &level))) {
+      fprintf(stderr, "aig_node_level: %s\n", strerror(rc));
+      ok = false;
+    } else if (level != expected) {
+      fprintf(stderr, "node for variable %" PRIu64 " has level %zu, expected "
+              "%zu\n", v, level, expected);
+      ok = false;
+    }
+  }
+
+  aig_iter_free(&it);
+  return ok;
+}
+
+/** find the variable whose depth a node has
+ *
+ * \param node Node to examine
+ * \returns The node’s variable index
+ */
+static uint64_t variable_index(const struct aig_node *node) {
+  switch (node->type) {
+    case AIG_CONSTANT: return 0;
+    case AIG_INPUT:    return node->input.variable_index;
+    case AIG_LATCH:    return node->latch.current;
+    case AIG_OUTPUT:   return node->output.variable_index;
+    case AIG_AND_GATE: return node->and_gate.lhs;
+  }
+  return 0;
+}
+
+/** check every node’s depth and slack, and the critical variables
+ *
+ * \param aig AIG to examine
+ * \param levels Level of every variable
+ * \param depths Depth of every variable
+ * \returns True if they agree
+ */
+static bool check_depths(aig_t *aig, const uint32_t *levels,
+    const uint32_t *depths) {
+
+  // the longest path ends at the deepest output or latch next state
+  uint64_t sink_level = 0;
+  struct aig_node n;
+  int rc = 0;
+  for (uint64_t i = 0; i < aig_output_count(aig); i++) {
+    if ((rc = aig_get_output_no_symbol(aig, i, &n)))
+      break;
+    if (levels[n.output.variable_index] > sink_level)
+      sink_level = levels[n.output.variable_index];
+  }
+  for (uint64_t i = 0; rc == 0 && i < aig_latch_count(aig); i++) {
+    if ((rc = aig_get_latch_no_symbol(aig, i, &n)))
+      break;
+    if (levels[n.latch.next] > sink_level)
+      sink_level = levels[n.latch.next];
+  }
+  if (rc) {
+    fprintf(stderr, "%s\n", strerror(rc));
+    return false;
+  }
+
+  aig_node_iter_t *it = NULL;
+  if ((rc = aig_iter_no_symbol(aig, &it))) {
+    fprintf(stderr, "aig_iter_no_symbol: %s\n", strerror(rc));
+    return false;
+  }
+
+  bool ok = true;
+  while (ok && aig_iter_has_next(it)) {
+
+    if ((rc = aig_iter_next(it, &n))) {
+      fprintf(stderr, "aig_iter_next: %s\n", strerror(rc));
+      ok = false;
+      break;
+    }
+
+    uint64_t v = variable_index(&n);
+    size_t depth, slack;
+    int depth_rc = aig_node_depth(aig, &n, &depth);
+    int slack_rc = aig_node_slack(aig, &n, &slack);
+
+    if (depths[v] == UINT32_MAX) {
+      if (depth_rc != ENOENT || slack_rc != ENOENT) {
+        fprintf(stderr, "node for variable %" PRIu64 " reaches no sink but "
+                "has a depth or slack\n", v);
+        ok = false;
+      }
+    } else if (depth_rc || slack_rc) {
+      fprintf(stderr, "node for variable %" PRIu64 ": %s\n", v,
+              strerror(depth_rc ? depth_rc : slack_rc));
+      ok = false;
+    } else if (depth != depths[v]
+            || slack != sink_level - levels[v] - depths[v]) {
+      fprintf(stderr, "node for variable %" PRIu64 " has depth %zu and slack "
+              "%zu, expected %" PRIu32 " and %" PRIu64 "\n", v, depth, slack,
+              depths[v], sink_level - levels[v] - depths[v]);
+      ok = false;
+    }
+  }
+  aig_iter_free(&it);
+
+  // the critical variables are those on a longest path, in increasing order
+  uint64_t *critical = NULL;
+  size_t count = 0;
+  if (ok && (rc = aig_critical_variables(aig, &critical, &count))) {
+    fprintf(stderr, "aig_critical_variables: %s\n", strerror(rc));
+    ok = false;
+  }
+  size_t j = 0;
+  for (uint64_t v = 0; ok && v <= aig_max_index(aig); v++) {
+    bool expected = depths[v] != UINT32_MAX
+                 && levels[v] + (uint64_t)depths[v] == sink_level;
+    bool got = j < count && critical[j] == v;
+    if (got != expected) {
+      fprintf(stderr, "variable %" PRIu64 " is %scritical, expected %s\n", v,
+              got ? "" : "not ", expected ? "critical" : "not critical");
+      ok = false;
+    }
+    j += got;
+  }
+  if (ok && j != count) {
+    fprintf(stderr, "unexpected critical variables\n");
+    ok = false;
+  }
+  free(critical);
+
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc != 3 && argc != 4) {
+    fprintf(stderr, "usage: %s filename levels [depths]\n"
+                    "       %s filename ELOOP\n", argv[0], argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const char *filename = argv[1];
+  bool loop = strcmp(argv[2], "ELOOP") == 0;
+
+  int result = EXIT_SUCCESS;
+
+  for (size_t j = 0; j < sizeof(OPTIONS) / sizeof(OPTIONS[0]); j++) {
+
+    aig_t *aig = NULL;
+    int rc = aig_load(&aig, filename, OPTIONS[j]);
+    if (rc != 0) {
+      fprintf(stderr, "aig_load(%s): %s\n", filename, strerror(rc));
+      return EXIT_FAILURE;
+    }
+    uint64_t count = aig_max_index(aig) + 1;
+
+    const uint32_t *levels = NULL;
+    rc = aig_levels(aig, &levels);
+    if (loop) {
+      if (rc != ELOOP) {
+        fprintf(stderr, "aig_levels with options %zu: got %s, expected %s\n",
+                j, strerror(rc), strerror(ELOOP));
+        result = EXIT_FAILURE;
+      }
+    } else if (rc != 0) {
+      fprintf(stderr, "aig_levels with options %zu: %s\n", j, strerror(rc));
+      result = EXIT_FAILURE;
+    } else if (!check("level", levels, count, argv[2])
+            || !check_nodes(aig, levels)) {
+      fprintf(stderr, "failed with options %zu\n", j);
+      result = EXIT_FAILURE;
+    }
+
+    if (argc > 3) {
+      const uint32_t *depths = NULL;
+      if ((rc = aig_depths(aig, &depths))) {
+        fprintf(stderr, "aig_depths with options %zu: %s\n", j, strerror(rc));
+        result = EXIT_FAILURE;
+      } else if (!check("depth", depths, count, argv[3])
+              || !check_depths(aig, levels, depths)) {
+        fprintf(stderr, "depths failed with options %zu\n", j);
+        result = EXIT_FAILURE;
+      }
+    }
+
+    aig_free(&aig);
+  }
+
+  return result;
+}
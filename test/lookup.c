@@ -0,0 +1,199 @@
+// check that looking up a node by variable index finds its first definition
+//
+// The expected answer is found by brute force, scanning inputs, latches and
+// AND gates in order. Lookups are made on a freshly loaded AIG, so they have to
+// parse as much as they need themselves.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// most variables to look up
+enum { VARIABLES_MAX = 1 << 16 };
+
+/// compare two nodes, ignoring their names
+static bool node_eq(const struct aig_node *a, const struct aig_node *b) {
+
+  if (a->type != b->type)
+    return false;
+
+  switch (a->type) {
+
+    case AIG_CONSTANT:
+      return a->constant.is_true == b->constant.is_true;
+
+    case AIG_INPUT:
+      return a->input.variable_index == b->input.variable_index;
+
+    case AIG_LATCH:
+      return a->latch.current == b->latch.current
+          && a->latch.next == b->latch.next
+          && a->latch.next_negated == b->latch.next_negated;
+
+    case AIG_OUTPUT:
+      return false;
+
+    case AIG_AND_GATE:
+      return a->and_gate.lhs == b->and_gate.lhs
+          && a->and_gate.rhs[0] == b->and_gate.rhs[0]
+          && a->and_gate.rhs[1] == b->and_gate.rhs[1]
+          && a->and_gate.negated[0] == b->and_gate.negated[0]
+          && a->and_gate.negated[1] == b->and_gate.negated[1];
+  }
+
+  return false;
+}
+
+/** record a node as the definition of its variable, unless it already has one
+ *
+ * \param defs Definitions found so far, indexed by variable
+ * \param found Which variables have a definition
+ * \param variables Number of entries in defs
+ * \param v Variable the node defines
+ * \param node Node to record
+ */
+static void define(struct aig_node *defs, bool *found, uint64_t variables,
+    uint64_t v, const struct aig_node *node) {
+
+  if (v >= variables || found[v])
+    return;
+
+  defs[v] = *node;
+  found[v] = true;
+}
+
+/** find the first definition of every variable by scanning every node
+ *
+ * \param aig AIG to read
+ * \param defs [out] Definition of each variable
+ * \param found [out] Which variables have a definition
+ * \param variables Number of variables to consider
+ * \returns 0 on success or an errno on failure
+ */
+static int scan(aig_t *aig, struct aig_node *defs, bool *found,
+    uint64_t variables) {
+
+  struct aig_node n;
+  int rc = 0;
+
+  for (uint64_t i = 0; i < aig_input_count(aig); i++) {
+    if ((rc = aig_get_input_no_symbol(aig, i, &n)))
+      return rc;
+    define(defs, found, variables, n.input.variable_index, &n);
+  }
+
+  for (uint64_t i = 0; i < aig_latch_count(aig); i++) {
+    if ((rc = aig_get_latch_no_symbol(aig, i, &n)))
+      return rc;
+    define(defs, found, variables, n.latch.current, &n);
+  }
+
+  for (uint64_t i = 0; i < aig_and_count(aig); i++) {
+    if ((rc = aig_get_and(aig, i, &n)))
+      return rc;
+    define(defs, found, variables, n.and_gate.lhs, &n);
+  }
+
+  return 0;
+}
+
+/** look up every variable and compare against the expected definitions
+ *
+ * \param filename AIG to load
+ * \param options Options to load with
+ * \returns True if every lookup matched
+ */
+static bool check(const char *filename, struct aig_options options) {
+
+  aig_t *ref = NULL;
+  aig_t *aig = NULL;
+  struct aig_node *defs = NULL;
+  bool *found = NULL;
+  bool ok = false;
+
+  int rc = aig_load(&ref, filename, options);
+  if (rc == 0)
+    rc = aig_load(&aig, filename, options);
+  if (rc) {
+    fprintf(stderr, "aig_load(%s): %s\n", filename, strerror(rc));
+    goto done;
+  }
+
+  uint64_t variables = aig_max_index(ref) < VARIABLES_MAX
+                     ? aig_max_index(ref) + 1 : VARIABLES_MAX;
+  defs = calloc(variables, sizeof(defs[0]));
+  found = calloc(variables, sizeof(found[0]));
+  if (defs == NULL || found == NULL) {
+    fprintf(stderr, "out of memory\n");
+    goto done;
+  }
+
+  if ((rc = scan(ref, defs, found, variables))) {
+    fprintf(stderr, "%s: %s\n", filename, strerror(rc));
+    goto done;
+  }
+
+  // look up each variable in ascending order, so early lookups happen before
+  // later nodes have been parsed, and then again in descending order
+  ok = true;
+  for (uint64_t i = 0; i < variables * 2; i++) {
+    uint64_t v = i < variables ? i : variables * 2 - 1 - i;
+    if (v == 0)
+      continue;
+
+    struct aig_node n;
+    rc = aig_get_node_no_symbol(aig, v, &n);
+    if (!found[v]) {
+      if (rc != ERANGE) {
+        fprintf(stderr, "%s: variable %" PRIu64 " is undefined but lookup "
+                "returned %s\n", filename, v, strerror(rc));
+        ok = false;
+      }
+    } else if (rc) {
+      fprintf(stderr, "%s: variable %" PRIu64 ": %s\n", filename, v,
+              strerror(rc));
+      ok = false;
+    } else if (!node_eq(&n, &defs[v])) {
+      fprintf(stderr, "%s: variable %" PRIu64 " found a node other than its "
+              "first definition\n", filename, v);
+      ok = false;
+    }
+  }
+
+done:
+  free(found);
+  free(defs);
+  if (aig != NULL)
+    aig_free(&aig);
+  if (ref != NULL)
+    aig_free(&ref);
+
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s filename...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+    for (int eager = 0; eager < 2; eager++) {
+      struct aig_options options = { .eager = eager };
+      if (!check(argv[i], options)) {
+        fprintf(stderr, "%s failed with eager = %d\n", argv[i], eager);
+        result = EXIT_FAILURE;
+      }
+    }
+  }
+
+  return result;
+}
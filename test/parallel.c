@@ -0,0 +1,187 @@
+// check that parsing AND gates on multiple threads matches parsing them on one
+//
+// The AIG is generated in memory, with an AND gates section large enough to be
+// split into several chunks. It is then parsed again with a malformed line
+// injected into a later chunk, which should fail identically either way.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { INPUTS = 1000, ANDS = 300000 };
+
+/// a simple deterministic pseudo-random number generator
+static uint64_t rand_next(uint64_t *state) {
+  *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+  return *state >> 33;
+}
+
+/** generate an ASCII AIG
+ *
+ * The AND gates mostly appear in order, but some pairs are swapped so their
+ * LHSs have to be recorded as out of sequence.
+ *
+ * \param length [out] Length of the generated text
+ * \param bad_offset [out] Offset of a line late in the AND gates section
+ * \returns The generated text, or NULL if out of memory
+ */
+static char *generate(size_t *length, size_t *bad_offset) {
+
+  size_t capacity = 64 + (size_t)INPUTS * 10 + (size_t)ANDS * 32 + 1024;
+  char *text = malloc(capacity);
+  if (text == NULL)
+    return NULL;
+
+  size_t n = 0;
+  n += (size_t)sprintf(text + n, "aag %d %d 0 1 %d\n", INPUTS + ANDS, INPUTS,
+                       ANDS);
+  for (int i = 1; i <= INPUTS; i++)
+    n += (size_t)sprintf(text + n, "%d\n", i * 2);
+  n += (size_t)sprintf(text + n, "%d\n", (INPUTS + ANDS) * 2 + 1);
+
+  uint64_t state = 1;
+  for (uint64_t i = 0; i < ANDS; i++) {
+
+    // swap this gate with the next one every so often
+    uint64_t v = INPUTS + 1 + i;
+    if (i % 97 == 10)
+      v += 1;
+    else if (i % 97 == 11)
+      v -= 1;
+
+    if (i == ANDS * 3 / 4)
+      *bad_offset = n;
+
+    uint64_t rhs0 = rand_next(&state) % (INPUTS * 2) + 2;
+    uint64_t rhs1 = rand_next(&state) % (INPUTS * 2) + 2;
+    n += (size_t)sprintf(text + n, "%" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+                         v * 2, rhs0, rhs1);
+  }
+
+  // a symbol table and comments, some of which look like AND gates
+  n += (size_t)sprintf(text + n, "i0 a\no0 x\nc\n2 4 6\nnot a gate\n");
+
+  *length = n;
+  return text;
+}
+
+/** compare the AND gates of an AIG parsed on one and multiple threads
+ *
+ * \param text AIG to parse
+ * \param length Length of text
+ * \param options Options to parse with, other than threads
+ * \returns True if they match
+ */
+static bool compare(const char *text, size_t length,
+    struct aig_options options) {
+
+  aig_t *seq = NULL;
+  aig_t *par = NULL;
+
+  options.threads = 1;
+  int rc_seq = aig_parse_buffer(&seq, text, length, options);
+  options.threads = 4;
+  int rc_par = aig_parse_buffer(&par, text, length, options);
+
+  bool ok = rc_seq == rc_par;
+  if (!ok)
+    fprintf(stderr, "aig_parse_buffer: got %s, expected %s\n", strerror(rc_par),
+            strerror(rc_seq));
+
+  for (uint64_t i = 0; ok && rc_seq == 0 && i < ANDS; i++) {
+
+    // fetch the last gate first, so the lazy parser reads the rest in one go
+    uint64_t index = i == 0 ? ANDS - 1 : i - 1;
+
+    struct aig_node a, b;
+    int ra = aig_get_and(seq, index, &a);
+    int rb = aig_get_and(par, index, &b);
+    if (ra != rb) {
+      fprintf(stderr, "AND gate %" PRIu64 ": got %s, expected %s\n", index,
+              strerror(rb), strerror(ra));
+      ok = false;
+    } else if (ra == 0 && (a.and_gate.lhs != b.and_gate.lhs
+               || a.and_gate.rhs[0] != b.and_gate.rhs[0]
+               || a.and_gate.rhs[1] != b.and_gate.rhs[1]
+               || a.and_gate.negated[0] != b.and_gate.negated[0]
+               || a.and_gate.negated[1] != b.and_gate.negated[1])) {
+      fprintf(stderr, "AND gate %" PRIu64 ": gates differ\n", index);
+      ok = false;
+    }
+  }
+
+  // the symbol table should be found where it was
+  if (ok && rc_seq == 0) {
+    struct aig_node a, b;
+    int ra = aig_get_input(seq, 0, &a);
+    int rb = aig_get_input(par, 0, &b);
+    if (ra != rb || (ra == 0 && (a.input.name == NULL || b.input.name == NULL
+        || strcmp(a.input.name, b.input.name) != 0))) {
+      fprintf(stderr, "input 0: symbols differ\n");
+      ok = false;
+    }
+  }
+
+  if (par != NULL)
+    aig_free(&par);
+  if (seq != NULL)
+    aig_free(&seq);
+
+  return ok;
+}
+
+/** compare parsing in each mode
+ *
+ * \param what Description of the AIG for error messages
+ * \param text AIG to parse
+ * \param length Length of text
+ * \returns True if every mode matched
+ */
+static bool compare_all(const char *what, const char *text, size_t length) {
+
+  bool ok = true;
+  for (int strict = 0; strict < 2; strict++) {
+    for (int eager = 0; eager < 2; eager++) {
+      struct aig_options options = { .strict = strict, .eager = eager };
+      if (!compare(text, length, options)) {
+        fprintf(stderr, "%s differs with strict = %d, eager = %d\n", what,
+                strict, eager);
+        ok = false;
+      }
+    }
+  }
+
+  return ok;
+}
+
+int main(void) {
+
+  size_t length = 0;
+  size_t bad_offset = 0;
+  char *text = generate(&length, &bad_offset);
+  if (text == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return EXIT_FAILURE;
+  }
+
+  bool ok = compare_all("well formed AIG", text, length);
+
+  // corrupt the first RHS of a gate late in the section
+  char *rhs = strchr(text + bad_offset, ' ') + 1;
+  *rhs = 'x';
+  ok &= compare_all("AIG with a malformed gate", text, length);
+
+  // restore it, and instead make the gate’s LHS out of range
+  *rhs = '2';
+  memset(text + bad_offset, '9', (size_t)(rhs - 1 - (text + bad_offset)));
+  ok &= compare_all("AIG with an out of range gate", text, length);
+
+  free(text);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,216 @@
+// check SAT output restricted to a cone of influence
+//
+// For each output, and for every output at once, aig_to_sat_file_cone() should
+// declare each variable in the sequential cone of influence, named as its
+// first definition is, and then constrain each latch and AND gate in the cone.
+// Both passes go in increasing order of variable index.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// is a variable set in a bitset?
+static bool is_set(const uint64_t *bits, uint64_t v) {
+  return (bits[v / 64] >> (v % 64)) & 1;
+}
+
+/** write what one pass should emit for a cone
+ *
+ * \param aig AIG being translated
+ * \param cone Which variables are in the cone
+ * \param define Whether to write declarations rather than constraints
+ * \param f Output to write to
+ * \returns 0 on success or an errno on failure
+ */
+static int expect(aig_t *aig, const uint64_t *cone, bool define, FILE *f) {
+
+  for (uint64_t v = 1; v <= aig_max_index(aig); v++) {
+
+    if (!is_set(cone, v))
+      continue;
+
+    struct aig_node n;
+    int rc = aig_get_node(aig, v, &n);
+    if (rc == ERANGE)
+      continue;
+    if (rc)
+      return rc;
+
+    char *text = NULL;
+    if (define) {
+      rc = aig_node_to_sat_define(&n, &text);
+    } else {
+      rc = aig_node_to_sat_constraint(&n, &text);
+    }
+    if (rc)
+      return rc;
+    fputs(text, f);
+    free(text);
+  }
+
+  return 0;
+}
+
+/** check the SAT output for the cone of some outputs
+ *
+ * \param aig AIG to translate
+ * \param outputs Indices of the outputs of interest
+ * \param count Number of entries in outputs
+ * \returns True if it was as expected
+ */
+static bool check(aig_t *aig, const uint64_t *outputs, size_t count) {
+
+  uint64_t *literals = calloc(count + 1, sizeof(literals[0]));
+  if (literals == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return false;
+  }
+
+  int rc = 0;
+  for (size_t i = 0; rc == 0 && i < count; i++) {
+    struct aig_node n;
+    if ((rc = aig_get_output_no_symbol(aig, outputs[i], &n)) == 0)
+      literals[i] = n.output.variable_index * 2 + n.output.negated;
+  }
+
+  uint64_t *cone = NULL;
+  if (rc == 0)
+    rc = aig_cone(aig, literals, count, true, &cone);
+  free(literals);
+  if (rc) {
+    fprintf(stderr, "%s\n", strerror(rc));
+    return false;
+  }
+
+  char *expected = NULL;
+  size_t expected_size = 0;
+  FILE *f = open_memstream(&expected, &expected_size);
+  if (f == NULL) {
+    fprintf(stderr, "open_memstream: %s\n", strerror(errno));
+    free(cone);
+    return false;
+  }
+  if ((rc = expect(aig, cone, true, f)) == 0)
+    rc = expect(aig, cone, false, f);
+  fclose(f);
+  free(cone);
+  if (rc) {
+    fprintf(stderr, "%s\n", strerror(rc));
+    free(expected);
+    return false;
+  }
+
+  char *got = NULL;
+  size_t got_size = 0;
+  if ((f = open_memstream(&got, &got_size)) == NULL) {
+    fprintf(stderr, "open_memstream: %s\n", strerror(errno));
+    free(expected);
+    return false;
+  }
+  rc = aig_to_sat_file_cone(aig, outputs, count, f);
+  fclose(f);
+
+  bool ok = true;
+  if (rc) {
+    fprintf(stderr, "aig_to_sat_file_cone: %s\n", strerror(rc));
+    ok = false;
+  } else if (strcmp(got, expected) != 0) {
+    fprintf(stderr, "got:\n%sexpected:\n%s", got, expected);
+    ok = false;
+  }
+
+  free(got);
+  free(expected);
+  return ok;
+}
+
+/** check the SAT output for the cones of an AIG’s outputs
+ *
+ * \param aig AIG to translate
+ * \returns True if they were all as expected
+ */
+static bool check_all(aig_t *aig) {
+
+  uint64_t count = aig_output_count(aig);
+  uint64_t *outputs = calloc(count + 1, sizeof(outputs[0]));
+  if (outputs == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return false;
+  }
+
+  bool ok = true;
+  for (uint64_t i = 0; ok && i < count; i++) {
+    outputs[i] = i;
+    if (!check(aig, &outputs[i], 1)) {
+      fprintf(stderr, "cone of output %" PRIu64 " failed\n", i);
+      ok = false;
+    }
+  }
+
+  if (ok && !check(aig, outputs, count)) {
+    fprintf(stderr, "cone of all outputs failed\n");
+    ok = false;
+  }
+
+  // an output beyond the AIG should be rejected
+  if (ok) {
+    char *text = NULL;
+    size_t size = 0;
+    FILE *f = open_memstream(&text, &size);
+    if (f == NULL) {
+      fprintf(stderr, "open_memstream: %s\n", strerror(errno));
+      ok = false;
+    } else {
+      int rc = aig_to_sat_file_cone(aig, &count, 1, f);
+      fclose(f);
+      free(text);
+      if (rc != ERANGE) {
+        fprintf(stderr, "aig_to_sat_file_cone(%" PRIu64 "): got %s, expected "
+                "%s\n", count, strerror(rc), strerror(ERANGE));
+        ok = false;
+      }
+    }
+  }
+
+  free(outputs);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s filename...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+    for (int eager = 0; eager < 2; eager++) {
+      struct aig_options options = { .eager = eager };
+
+      aig_t *aig = NULL;
+      int rc = aig_load(&aig, argv[i], options);
+      if (rc) {
+        fprintf(stderr, "aig_load(%s): %s\n", argv[i], strerror(rc));
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      if (!check_all(aig)) {
+        fprintf(stderr, "%s failed with eager = %d\n", argv[i], eager);
+        result = EXIT_FAILURE;
+      }
+
+      aig_free(&aig);
+    }
+  }
+
+  return result;
+}
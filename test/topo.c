@@ -0,0 +1,193 @@
+// check the topological iterator
+//
+// Every AND gate should be yielded exactly once, and only after the gate
+// defining each of its operands. With --loop, the AIG is instead expected to
+// contain a combinational cycle, which the iterator should report.
+
+#include <aig/aig.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// compare two AND gates
+static bool and_eq(const struct aig_node *a, const struct aig_node *b) {
+  return a->type == AIG_AND_GATE && b->type == AIG_AND_GATE
+      && a->and_gate.lhs == b->and_gate.lhs
+      && a->and_gate.rhs[0] == b->and_gate.rhs[0]
+      && a->and_gate.rhs[1] == b->and_gate.rhs[1]
+      && a->and_gate.negated[0] == b->and_gate.negated[0]
+      && a->and_gate.negated[1] == b->and_gate.negated[1];
+}
+
+/** is an operand ready to be used?
+ *
+ * \param aig AIG to examine
+ * \param defined Which variables have had their defining AND gate yielded
+ * \param v Variable of the operand
+ * \param ready [out] Whether the operand is an input, latch, undefined, or
+ *   defined by an AND gate already yielded
+ * \returns 0 on success or an errno on failure
+ */
+static int is_ready(aig_t *aig, const bool *defined, uint64_t v,
+    bool *ready) {
+
+  struct aig_node n;
+  int rc = aig_get_node_no_symbol(aig, v, &n);
+  if (rc == ERANGE) {
+    *ready = true;
+    return 0;
+  }
+  if (rc)
+    return rc;
+
+  *ready = n.type != AIG_AND_GATE || defined[v];
+  return 0;
+}
+
+/** check the order the topological iterator yields AND gates in
+ *
+ * \param aig AIG to examine
+ * \returns True if it was a topological order of every gate
+ */
+static bool check(aig_t *aig) {
+
+  uint64_t ands = aig_and_count(aig);
+  bool *defined = calloc(aig_max_index(aig) + 1, sizeof(defined[0]));
+  uint64_t *uses = calloc(ands + 1, sizeof(uses[0]));
+  if (defined == NULL || uses == NULL) {
+    fprintf(stderr, "out of memory\n");
+    free(uses);
+    free(defined);
+    return false;
+  }
+
+  aig_node_iter_t *it = NULL;
+  int rc = aig_iter_topological(aig, &it);
+  if (rc) {
+    fprintf(stderr, "aig_iter_topological: %s\n", strerror(rc));
+    free(uses);
+    free(defined);
+    return false;
+  }
+
+  bool ok = true;
+  uint64_t yielded = 0;
+  while (ok && aig_iter_has_next(it)) {
+
+    struct aig_node gate;
+    if ((rc = aig_iter_next(it, &gate))) {
+      fprintf(stderr, "aig_iter_next: %s\n", strerror(rc));
+      ok = false;
+      break;
+    }
+    ++yielded;
+
+    for (size_t i = 0; ok && i < 2; i++) {
+      bool ready;
+      if ((rc = is_ready(aig, defined, gate.and_gate.rhs[i], &ready))) {
+        fprintf(stderr, "%s\n", strerror(rc));
+        ok = false;
+      } else if (!ready) {
+        fprintf(stderr, "gate defining %" PRIu64 " yielded before its operand "
+                "%" PRIu64 "\n", gate.and_gate.lhs, gate.and_gate.rhs[i]);
+        ok = false;
+      }
+    }
+
+    // find which gate this was, to make sure each is only yielded once
+    for (uint64_t i = 0; ok && i < ands; i++) {
+      struct aig_node n;
+      if ((rc = aig_get_and(aig, i, &n))) {
+        fprintf(stderr, "aig_get_and(%" PRIu64 "): %s\n", i, strerror(rc));
+        ok = false;
+      } else if (and_eq(&n, &gate) && uses[i] == 0) {
+        ++uses[i];
+        break;
+      }
+    }
+
+    // only the first definition of a variable is what its users see
+    struct aig_node first;
+    if (ok && aig_get_node_no_symbol(aig, gate.and_gate.lhs, &first) == 0
+        && and_eq(&first, &gate))
+      defined[gate.and_gate.lhs] = true;
+  }
+
+  for (uint64_t i = 0; ok && i < ands; i++) {
+    if (uses[i] != 1) {
+      fprintf(stderr, "gate %" PRIu64 " was not yielded exactly once\n", i);
+      ok = false;
+    }
+  }
+
+  if (ok && yielded != ands) {
+    fprintf(stderr, "yielded %" PRIu64 " gates, expected %" PRIu64 "\n",
+            yielded, ands);
+    ok = false;
+  }
+
+  aig_iter_free(&it);
+  free(uses);
+  free(defined);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  const char *argv0 = argv[0];
+
+  bool loop = false;
+  if (argc > 1 && strcmp(argv[1], "--loop") == 0) {
+    loop = true;
+    --argc;
+    ++argv;
+  }
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s [--loop] filename...\n", argv0);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (int i = 1; i < argc; i++) {
+    for (int eager = 0; eager < 2; eager++) {
+      struct aig_options options = { .eager = eager };
+
+      aig_t *aig = NULL;
+      int rc = aig_load(&aig, argv[i], options);
+      if (rc) {
+        fprintf(stderr, "aig_load(%s): %s\n", argv[i], strerror(rc));
+        result = EXIT_FAILURE;
+        continue;
+      }
+
+      bool ok;
+      if (loop) {
+        aig_node_iter_t *it = NULL;
+        rc = aig_iter_topological(aig, &it);
+        ok = rc == ELOOP;
+        if (!ok)
+          fprintf(stderr, "aig_iter_topological: got %s, expected %s\n",
+                  strerror(rc), strerror(ELOOP));
+        if (it != NULL)
+          aig_iter_free(&it);
+      } else {
+        ok = check(aig);
+      }
+
+      if (!ok) {
+        fprintf(stderr, "%s failed with eager = %d\n", argv[i], eager);
+        result = EXIT_FAILURE;
+      }
+
+      aig_free(&aig);
+    }
+  }
+
+  return result;
+}